@@ -0,0 +1,70 @@
+// Output shared by the benchmarks. The results are printed to stdout as JSON
+// (default) or CSV (`--csv`), one record per metric, so that they can be
+// compared between versions:
+//
+//   {
+//     "backend": "dummy",
+//     "platform": "null",
+//     "results": [
+//       {"benchmark": "steady", "variant": "glue", "metric": "frame", "value": 0.123, "unit": "us"},
+//       ...
+//     ]
+//   }
+//
+// Include it after sokol_glfw_glue.h (for GLFW's timer).
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdbool.h> // bool
+#include <stdint.h>  // uint64_t
+#include <stdio.h>   // printf
+
+static bool g_csv = false;
+
+static bool g_first_record = true;
+
+static inline double elapsed_ns(uint64_t start) {
+  return (double)(glfwGetTimerValue() - start) * 1e9 / (double)glfwGetTimerFrequency();
+}
+
+// Either name can be `NULL` to leave it out of the JSON output.
+static inline void print_begin(const char* backend, const char* platform) {
+  if (g_csv) {
+    printf("benchmark,variant,metric,value,unit\n");
+    return;
+  }
+
+  printf("{\n");
+  if (backend) {
+    printf("  \"backend\": \"%s\",\n", backend);
+  }
+  if (platform) {
+    printf("  \"platform\": \"%s\",\n", platform);
+  }
+  printf("  \"results\": [\n");
+}
+
+static inline void print_record(const char* benchmark, const char* variant, const char* metric, double value, const char* unit) {
+  if (g_csv) {
+    printf("%s,%s,%s,%.3f,%s\n", benchmark, variant, metric, value, unit);
+  } else {
+    printf(
+      "%s    {\"benchmark\": \"%s\", \"variant\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}",
+      g_first_record ? "" : ",\n",
+      benchmark,
+      variant,
+      metric,
+      value,
+      unit);
+  }
+  g_first_record = false;
+}
+
+static inline void print_end(void) {
+  if (!g_csv) {
+    printf("\n  ]\n}\n");
+  }
+}
+
+#endif // BENCH_COMMON_H
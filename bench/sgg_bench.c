@@ -0,0 +1,213 @@
+// Frame loop benchmarks of the glue, on the dummy backend and GLFW's null
+// platform, so that they run on headless machines too:
+//
+//   - startup: time from creating the window to the first presented frame,
+//              with the device created synchronously or in the background,
+//   - steady:  cost of `sgg_swapchain` + `sgg_present` per frame, on its own
+//              and wrapped in an empty sokol_gfx pass,
+//   - resize:  count and cost of the backbuffer reallocations while the window
+//              is dragged from 320 px wide to 4K and back, per resize policy.
+//
+// The results are printed as described in bench_common.h.
+//
+// Usage: sgg_bench [--csv] [--frames N]
+
+#define SOKOL_IMPL
+#define SOKOL_DUMMY_BACKEND
+#define SGG_ENABLE_FRAME_STATS
+#include "sokol_gfx.h"
+#include "sokol_glfw_glue.h"
+
+#include "bench_common.h"
+
+#include <stdio.h>  // printf, fprintf
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+
+static GLFWwindow* create_window(int width, int height) {
+  glfwDefaultWindowHints();
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+  return glfwCreateWindow(width, height, "sgg_bench", NULL, NULL);
+}
+
+static void setup(GLFWwindow* window, const sgg_environment_desc* desc) {
+  sgg_environment_desc env_desc = *desc;
+  env_desc.window               = window;
+
+  sg_setup(&(sg_desc){
+    .environment = sgg_environment(&env_desc),
+  });
+}
+
+static void teardown(GLFWwindow* window) {
+  sg_shutdown();
+  sgg_shutdown();
+  glfwDestroyWindow(window);
+}
+
+static void frame(bool pass) {
+  sg_swapchain swapchain = sgg_swapchain();
+  if (pass) {
+    sg_begin_pass(&(sg_pass){.swapchain = swapchain});
+    sg_end_pass();
+    sg_commit();
+  }
+  sgg_present();
+}
+
+// With `async`, the device is created while the window is (see STARTUP in
+// sokol_glfw_glue.h). The dummy backend has no device to create, so this only
+// tracks the cost of the machinery; the gain shows with the real backends (see
+// the example's `--startup`).
+static bool bench_startup(const char* variant, bool async, int runs) {
+  double min_ns   = 0.0;
+  double total_ns = 0.0;
+
+  for (int i = 0; i < runs; i++) {
+    uint64_t start = glfwGetTimerValue();
+    if (async) {
+      sgg_environment_begin_async();
+    }
+    GLFWwindow* window = create_window(1280, 720);
+    if (!window) {
+      return false;
+    }
+    setup(window, &(sgg_environment_desc){0});
+    frame(true);
+    double ns = elapsed_ns(start);
+
+    teardown(window);
+
+    min_ns = i == 0 || ns < min_ns ? ns : min_ns;
+    total_ns += ns;
+  }
+
+  print_record("startup", variant, "min", min_ns / 1000.0, "us");
+  print_record("startup", variant, "avg", total_ns / runs / 1000.0, "us");
+  return true;
+}
+
+static bool bench_steady(int frames) {
+  GLFWwindow* window = create_window(1280, 720);
+  if (!window) {
+    return false;
+  }
+  setup(window, &(sgg_environment_desc){0});
+  frame(true);
+
+  static const char* variants[] = {"glue", "pass"};
+
+  uint64_t resize_count = sgg_query_frame_stats().resize_count;
+
+  for (int variant = 0; variant < 2; variant++) {
+    bool pass = variant == 1;
+
+    for (int i = 0; i < frames / 10; i++) {
+      frame(pass);
+    }
+
+    uint64_t start = glfwGetTimerValue();
+    for (int i = 0; i < frames; i++) {
+      frame(pass);
+    }
+    print_record("steady", variants[variant], "frame", elapsed_ns(start) / frames, "ns");
+  }
+
+  // The steady state must not reallocate anything.
+  print_record("steady", "all", "resizes", (double)(sgg_query_frame_stats().resize_count - resize_count), "count");
+
+  teardown(window);
+  return true;
+}
+
+// Drags the window from 320 px wide to 4K (16:9) and back, 16 px per frame.
+static bool bench_resize_storm(const char* variant, const sgg_environment_desc* desc) {
+  GLFWwindow* window = create_window(320, 180);
+  if (!window) {
+    return false;
+  }
+  setup(window, desc);
+  frame(true);
+
+  uint64_t resize_count  = sgg_query_frame_stats().resize_count;
+  uint64_t start_count   = resize_count;
+  uint64_t peak_bytes    = 0;
+  double   total_ns      = 0.0;
+  double   resize_ns     = 0.0;
+  double   max_resize_ns = 0.0;
+  int      frames        = 0;
+  int      steps         = (3840 - 320) / 16;
+
+  for (int i = 1; i <= 2 * steps; i++) {
+    int width = 320 + 16 * (i <= steps ? i : 2 * steps - i);
+    glfwSetWindowSize(window, width, width * 9 / 16);
+    glfwPollEvents();
+
+    uint64_t start = glfwGetTimerValue();
+    frame(true);
+    double ns = elapsed_ns(start);
+
+    sgg_frame_stats stats = sgg_query_frame_stats();
+    if (stats.resize_count != resize_count) {
+      resize_count = stats.resize_count;
+      resize_ns += ns;
+      max_resize_ns = ns > max_resize_ns ? ns : max_resize_ns;
+    }
+    peak_bytes = stats.backbuffer_bytes > peak_bytes ? stats.backbuffer_bytes : peak_bytes;
+    total_ns += ns;
+    frames++;
+  }
+
+  uint64_t resizes = resize_count - start_count;
+
+  print_record("resize_storm", variant, "frames", frames, "count");
+  print_record("resize_storm", variant, "resizes", (double)resizes, "count");
+  print_record("resize_storm", variant, "frame_avg", total_ns / frames / 1000.0, "us");
+  print_record("resize_storm", variant, "resize_frame_avg", resizes ? resize_ns / (double)resizes / 1000.0 : 0.0, "us");
+  print_record("resize_storm", variant, "resize_frame_max", max_resize_ns / 1000.0, "us");
+  print_record("resize_storm", variant, "peak_backbuffer", (double)peak_bytes / (1024.0 * 1024.0), "MiB");
+
+  teardown(window);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int frames = 100000;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      frames = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [--frames N]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (!glfwInit()) {
+    return 1;
+  }
+
+  print_begin("dummy", "null");
+
+  bool ok = bench_startup("first_frame", false, 20) && bench_startup("first_frame_async", true, 20) && bench_steady(frames);
+
+  ok = ok && bench_resize_storm("exact", &(sgg_environment_desc){0});
+  ok = ok && bench_resize_storm("exact_never_downsize", &(sgg_environment_desc){.backbuffer_never_downsize = true});
+  ok = ok && bench_resize_storm("exact_shrink_delay", &(sgg_environment_desc){.backbuffer_shrink_delay_frames = 30});
+  ok = ok && bench_resize_storm("grow_pow2", &(sgg_environment_desc){.resize_policy = SGG_RESIZE_POLICY_GROW_POW2});
+  ok = ok && bench_resize_storm("grow_1_5x", &(sgg_environment_desc){.resize_policy = SGG_RESIZE_POLICY_GROW_1_5X});
+  ok = ok && bench_resize_storm("fit_monitor", &(sgg_environment_desc){.backbuffer_fit_monitor = true});
+
+  print_end();
+
+  glfwTerminate();
+
+  if (!ok) {
+    fprintf(stderr, "Failed to create a window.\n");
+    return 1;
+  }
+  return 0;
+}
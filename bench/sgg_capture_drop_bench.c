@@ -0,0 +1,124 @@
+// Frames dropped by the capture (see CAPTURE in sokol_glfw_glue.h) when a 4K
+// window presents at 60 fps, per capture queue size, on the dummy backend and
+// GLFW's null platform. The frames are converted to I420 and written to a Y4M
+// file, so the writer's pace is the machine's conversion and disk speed:
+//
+//   - written: frames that made it to the file,
+//   - dropped: frames that didn't fit in the queue, or were left in flight at
+//              the end of the capture.
+//
+// The results are printed as described in bench_common.h.
+//
+// Usage: sgg_capture_drop_bench [--csv] [--frames N] [--out capture.y4m]
+
+#define SOKOL_IMPL
+#define SOKOL_DUMMY_BACKEND
+#define SGG_ENABLE_CAPTURE
+#include "sokol_gfx.h"
+#include "sokol_glfw_glue.h"
+
+#include "bench_common.h"
+
+#include <stdio.h>  // fprintf, remove, snprintf
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+
+static const int g_queue_sizes[] = {3, 8, 16};
+
+// Presents `frames` frames at 60 fps (busy waiting, to keep the intervals
+// exact) while capturing them. Returns `false` if the capture can't start.
+static bool bench(const char* out, int queue_size, int frames) {
+  bool ok = sgg_begin_capture(&(sgg_capture_desc){
+    .path       = out,
+    .format     = SGG_CAPTURE_FORMAT_I420,
+    .container  = SGG_CAPTURE_CONTAINER_Y4M,
+    .queue_size = queue_size,
+  });
+  if (!ok) {
+    return false;
+  }
+
+  uint64_t frequency = glfwGetTimerFrequency();
+  uint64_t start     = glfwGetTimerValue();
+  for (int i = 0; i < frames; i++) {
+    uint64_t deadline = start + (uint64_t)i * frequency / 60;
+    while (glfwGetTimerValue() < deadline) {
+    }
+
+    sg_swapchain swapchain = sgg_swapchain();
+    sg_begin_pass(&(sg_pass){.swapchain = swapchain});
+    sg_end_pass();
+    sg_commit();
+    sgg_present();
+  }
+
+  sgg_end_capture();
+  sgg_capture_stats stats = sgg_query_capture_stats();
+
+  char variant[32];
+  snprintf(variant, sizeof(variant), "queue%d", queue_size);
+  print_record("capture_4k60", variant, "written", (double)stats.frames_written, "frames");
+  print_record("capture_4k60", variant, "dropped", (double)stats.frames_dropped, "frames");
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const char* out    = "sgg_capture_drop_bench.y4m";
+  bool        keep   = false;
+  int         frames = 300;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      out  = argv[++i];
+      keep = true;
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [--frames N] [--out capture.y4m]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (!glfwInit()) {
+    return 1;
+  }
+
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+  GLFWwindow* window = glfwCreateWindow(3840, 2160, "sgg_capture_drop_bench", NULL, NULL);
+  if (!window) {
+    fprintf(stderr, "Failed to create a window.\n");
+    glfwTerminate();
+    return 1;
+  }
+
+  sg_setup(&(sg_desc){
+    .environment = sgg_environment(&(sgg_environment_desc){.window = window}),
+  });
+
+  print_begin("dummy", "null");
+
+  bool ok = true;
+  for (int i = 0; ok && i < (int)(sizeof(g_queue_sizes) / sizeof(g_queue_sizes[0])); i++) {
+    ok = bench(out, g_queue_sizes[i], frames);
+  }
+
+  print_end();
+
+  if (!keep) {
+    remove(out);
+  }
+
+  sg_shutdown();
+  sgg_shutdown();
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  if (!ok) {
+    fprintf(stderr, "Failed to start the capture to %s.\n", out);
+    return 1;
+  }
+  return 0;
+}
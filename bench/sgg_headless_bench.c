@@ -0,0 +1,160 @@
+// Batch rendering throughput in the headless mode (see HEADLESS in
+// sokol_glfw_glue.h), on the OpenGL Core backend with an EGL context and
+// GLFW's null platform, so that it runs on servers without any display:
+//
+//   - startup:  time to create the EGL context and set up sokol_gfx,
+//   - clear:    frames per second of a cleared pass each, presented,
+//   - readback: the same, with every frame read back to the CPU (and checked),
+//               as a batch job writing out thumbnails would do,
+//   - msaa:     the read back frames with 4x MSAA, resolved before the copy.
+//
+// The results are printed as described in bench_common.h, and the renderer
+// used (e.g., llvmpipe, or a GPU) to stderr.
+//
+// Usage: sgg_headless_bench [--csv] [--frames N] [--width W] [--height H]
+
+#define SOKOL_IMPL
+#define SOKOL_GLCORE
+#include "sokol_gfx.h"
+#include "sokol_glfw_glue.h"
+
+#include "bench_common.h"
+
+#include <stdio.h>  // printf, fprintf
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+
+// The red channel encodes the frame index, so that the read back frames can be
+// matched with the rendered ones.
+static void frame(int index) {
+  sg_begin_pass(&(sg_pass){
+    .action.colors[0] = {
+      .load_action = SG_LOADACTION_CLEAR,
+      .clear_value = {(float)(index % 256) / 255.0f, 0.5f, 1.0f, 1.0f},
+    },
+    .swapchain = sgg_swapchain(),
+  });
+  sg_end_pass();
+  sg_commit();
+  sgg_present();
+}
+
+// Returns `false` if the first pixel (BGRA) doesn't have the frame's clear
+// color.
+static bool check_readback(const sgg_readback* readback) {
+  const uint8_t* pixel = (const uint8_t*)readback->pixels;
+  return pixel[0] == 255 && pixel[2] == (uint8_t)(readback->frame_index % 256);
+}
+
+// Renders `frames` frames after a short warm-up. With `readback`, every frame
+// is read back, and the batch only ends once the last one has arrived.
+static void bench_batch(const char* variant, int frames, bool readback) {
+  int index = 0;
+  for (; index < frames / 10; index++) {
+    frame(index);
+  }
+
+  sgg_readback result;
+  int          received = 0;
+  int          invalid  = 0;
+  uint64_t     start    = glfwGetTimerValue();
+
+  for (int i = 0; i < frames; i++, index++) {
+    // All staging buffers in flight: waits for the oldest one.
+    while (readback && !sgg_request_readback()) {
+      if (sgg_poll_readback(&result)) {
+        invalid += !check_readback(&result);
+        received++;
+      }
+    }
+    frame(index);
+    while (readback && sgg_poll_readback(&result)) {
+      invalid += !check_readback(&result);
+      received++;
+    }
+  }
+  while (readback && received < frames) {
+    if (sgg_poll_readback(&result)) {
+      invalid += !check_readback(&result);
+      received++;
+    }
+  }
+
+  double ns = elapsed_ns(start);
+
+  print_record("batch", variant, "fps", (double)frames * 1e9 / ns, "fps");
+  print_record("batch", variant, "frame", ns / frames / 1000.0, "us");
+  if (readback) {
+    print_record("batch", variant, "invalid_frames", invalid, "count");
+  }
+}
+
+static bool run(int frames, int width, int height, const char* variant, int sample_count, bool readback) {
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+  GLFWwindow* window = glfwCreateWindow(width, height, "sgg_headless_bench", NULL, NULL);
+  if (!window) {
+    fprintf(stderr, "Failed to create a window.\n");
+    return false;
+  }
+
+  uint64_t       start = glfwGetTimerValue();
+  sg_environment env   = sgg_environment(&(sgg_environment_desc){
+    .window       = window,
+    .headless     = true,
+    .sample_count = sample_count,
+  });
+  if (!sgg_is_valid()) {
+    fprintf(stderr, "Failed to create the headless EGL context.\n");
+    glfwDestroyWindow(window);
+    return false;
+  }
+
+  sg_setup(&(sg_desc){.environment = env});
+  print_record("startup", variant, "setup", elapsed_ns(start) / 1e6, "ms");
+  fprintf(stderr, "%s: %s\n", variant, (const char*)glGetString(GL_RENDERER));
+
+  bench_batch(variant, frames, readback);
+
+  sg_shutdown();
+  sgg_shutdown();
+  glfwDestroyWindow(window);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int frames = 1000;
+  int width  = 1280;
+  int height = 720;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      width = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      height = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [--frames N] [--width W] [--height H]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (!glfwInit()) {
+    return 1;
+  }
+
+  print_begin("glcore", "null");
+
+  bool ok = run(frames, width, height, "clear", 1, false);
+  ok      = ok && run(frames, width, height, "readback", 1, true);
+  ok      = ok && run(frames, width, height, "msaa", 4, true);
+
+  print_end();
+
+  glfwTerminate();
+
+  return ok ? 0 : 1;
+}
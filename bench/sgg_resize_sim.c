@@ -0,0 +1,241 @@
+// Replays window resize traces through the backbuffer sizing (see RESIZE
+// SIMULATION in sokol_glfw_glue.h), and compares the resize policies by the
+// number of reallocations, peak backbuffer memory and wasted pixels.
+//
+// Without arguments, a few synthetic traces are used (a drag from 320 px wide
+// to 4K and back, hopping between a 1x and a 2x monitor, maximizing and
+// restoring, and a jittery live resize). The `max_monitor` policy pins the
+// backbuffer to an 8K display, as `sgg_max_monitor_size` would with one
+// connected, and `fit_monitor` only sizes for the window's current monitor.
+// Traces recorded with `sgg_begin_window_recording` can be stored as CSV and
+// passed as arguments:
+//
+//   time_ms,event,width,height,x_scale,y_scale
+//   0.000,monitor,1280,720,1.0,1.0
+//   0.000,monitor_size,1920,1080,0,0
+//   16.667,frame,0,0,0,0
+//   20.125,size,1300,731,0,0
+//   ...
+//
+// where `event` is one of `frame`, `size`, `scale`, `monitor` or `monitor_size`
+// (only recorded with `backbuffer_fit_monitor`). The results are printed as
+// described in bench_common.h.
+//
+// Usage: sgg_resize_sim [--csv] [trace.csv ...]
+
+#define SOKOL_IMPL
+#define SOKOL_DUMMY_BACKEND
+#include "sokol_gfx.h"
+#include "sokol_glfw_glue.h"
+
+#include "bench_common.h"
+
+#include <stdio.h>  // printf, fprintf, fopen, fgets, sscanf
+#include <stdlib.h> // malloc, realloc, free
+#include <string.h> // strcmp
+
+#define FRAME_MS (1000.0 / 60.0)
+
+typedef struct trace {
+  const char*       name;
+  sgg_window_event* events;
+  int               count;
+  int               capacity;
+  double            time_ms;
+} trace;
+
+typedef struct policy {
+  const char*          name;
+  sgg_environment_desc desc;
+} policy;
+
+static const policy g_policies[] = {
+  {"exact", {0}},
+  {"exact_never_downsize", {.backbuffer_never_downsize = true}},
+  {"exact_shrink_delay_frames", {.backbuffer_shrink_delay_frames = 30}},
+  {"exact_shrink_delay_ms", {.backbuffer_shrink_delay_ms = 500.0}},
+  {"grow_pow2", {.resize_policy = SGG_RESIZE_POLICY_GROW_POW2}},
+  {"grow_1_5x", {.resize_policy = SGG_RESIZE_POLICY_GROW_1_5X}},
+  {"max_monitor", {.backbuffer_min_width = 7680, .backbuffer_min_height = 4320, .backbuffer_never_downsize = true}},
+  {"fit_monitor", {.backbuffer_fit_monitor = true}},
+};
+
+static void push_event(trace* t, sgg_window_event event) {
+  if (t->count == t->capacity) {
+    t->capacity = t->capacity ? t->capacity * 2 : 256;
+    t->events   = (sgg_window_event*)realloc(t->events, (size_t)t->capacity * sizeof(sgg_window_event));
+  }
+  t->events[t->count++] = event;
+}
+
+static void push_size(trace* t, int width, int height) {
+  push_event(t, (sgg_window_event){.type = SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE, .time_ms = t->time_ms, .width = width, .height = height});
+}
+
+// The window's framebuffer size and scale on the monitor, and the monitor's
+// largest framebuffer size.
+static void push_monitor(trace* t, int width, int height, float scale, int monitor_width, int monitor_height) {
+  push_event(t, (sgg_window_event){
+    .type    = SGG_WINDOW_EVENT_MONITOR,
+    .time_ms = t->time_ms,
+    .width   = width,
+    .height  = height,
+    .x_scale = scale,
+    .y_scale = scale,
+  });
+  push_event(t, (sgg_window_event){
+    .type    = SGG_WINDOW_EVENT_MONITOR_SIZE,
+    .time_ms = t->time_ms,
+    .width   = monitor_width,
+    .height  = monitor_height,
+  });
+}
+
+static void push_frames(trace* t, int count) {
+  for (int i = 0; i < count; i++) {
+    t->time_ms += FRAME_MS;
+    push_event(t, (sgg_window_event){.type = SGG_WINDOW_EVENT_FRAME, .time_ms = t->time_ms});
+  }
+}
+
+// From 320 px wide to 4K (16:9) and back, 16 px per frame, on a 4K monitor.
+static trace make_drag_storm(void) {
+  trace t = {.name = "drag_storm"};
+  push_monitor(&t, 320, 180, 1.0f, 3840, 2160);
+  push_frames(&t, 1);
+
+  int steps = (3840 - 320) / 16;
+  for (int i = 1; i <= 2 * steps; i++) {
+    int width = 320 + 16 * (i <= steps ? i : 2 * steps - i);
+    push_size(&t, width, width * 9 / 16);
+    push_frames(&t, 1);
+  }
+  return t;
+}
+
+// A 1280 x 720 pt window moved between a 1x 1080p and a 2x 5K monitor every 2
+// seconds.
+static trace make_monitor_hop(void) {
+  trace t = {.name = "monitor_hop"};
+  for (int i = 0; i < 10; i++) {
+    float scale = i % 2 ? 2.0f : 1.0f;
+    push_monitor(&t, (int)(1280 * scale), (int)(720 * scale), scale, i % 2 ? 5120 : 1920, i % 2 ? 2880 : 1080);
+    push_frames(&t, 120);
+  }
+  return t;
+}
+
+// Maximizing and restoring a window on a 1080p monitor every second.
+static trace make_maximize_toggle(void) {
+  trace t = {.name = "maximize_toggle"};
+  push_monitor(&t, 1280, 720, 1.0f, 1920, 1080);
+  for (int i = 0; i < 20; i++) {
+    if (i % 2) {
+      push_size(&t, 1280, 720);
+    } else {
+      push_size(&t, 1920, 1017);
+    }
+    push_frames(&t, 60);
+  }
+  return t;
+}
+
+// Live resize around 1600 x 900, moving by a few pixels back and forth, on a
+// 1080p monitor.
+static trace make_jitter(void) {
+  trace    t    = {.name = "jitter"};
+  uint32_t seed = 1;
+  push_monitor(&t, 1600, 900, 1.0f, 1920, 1080);
+  for (int i = 0; i < 600; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    push_size(&t, 1600 + (int)(seed >> 24) % 17 - 8, 900 + (int)(seed >> 16 & 0xff) % 17 - 8);
+    push_frames(&t, 1);
+  }
+  return t;
+}
+
+static bool load_trace(const char* path, trace* t) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    return false;
+  }
+
+  *t = (trace){.name = path};
+
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    sgg_window_event event = {0};
+    char             type[16];
+    if (sscanf(line, "%lf,%15[a-z_],%d,%d,%f,%f", &event.time_ms, type, &event.width, &event.height, &event.x_scale, &event.y_scale) != 6) {
+      continue; // Header, or an empty line.
+    }
+
+    if (strcmp(type, "frame") == 0) {
+      event.type = SGG_WINDOW_EVENT_FRAME;
+    } else if (strcmp(type, "size") == 0) {
+      event.type = SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE;
+    } else if (strcmp(type, "scale") == 0) {
+      event.type = SGG_WINDOW_EVENT_CONTENT_SCALE;
+    } else if (strcmp(type, "monitor") == 0) {
+      event.type = SGG_WINDOW_EVENT_MONITOR;
+    } else if (strcmp(type, "monitor_size") == 0) {
+      event.type = SGG_WINDOW_EVENT_MONITOR_SIZE;
+    } else {
+      continue;
+    }
+    push_event(t, event);
+  }
+
+  fclose(file);
+  return true;
+}
+
+static void simulate(const trace* t) {
+  for (size_t i = 0; i < sizeof(g_policies) / sizeof(g_policies[0]); i++) {
+    const policy*         p      = &g_policies[i];
+    sgg_resize_sim_result result = sgg_simulate_resize(&p->desc, t->events, t->count);
+
+    print_record(t->name, p->name, "frames", (double)result.frames, "count");
+    print_record(t->name, p->name, "reallocations", (double)result.reallocations, "count");
+    print_record(t->name, p->name, "peak_backbuffer", (double)result.peak_backbuffer_bytes / (1024.0 * 1024.0), "MiB");
+    print_record(
+      t->name,
+      p->name,
+      "wasted_pixels",
+      result.backbuffer_pixels ? 100.0 * (double)result.wasted_pixels / (double)result.backbuffer_pixels : 0.0,
+      "%");
+  }
+}
+
+int main(int argc, char** argv) {
+  trace traces[16];
+  int   trace_count = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else if (argv[i][0] != '-' && trace_count < 16 && load_trace(argv[i], &traces[trace_count])) {
+      trace_count++;
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [trace.csv ...]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if (trace_count == 0) {
+    traces[trace_count++] = make_drag_storm();
+    traces[trace_count++] = make_monitor_hop();
+    traces[trace_count++] = make_maximize_toggle();
+    traces[trace_count++] = make_jitter();
+  }
+
+  print_begin(NULL, NULL);
+
+  for (int i = 0; i < trace_count; i++) {
+    simulate(&traces[i]);
+    free(traces[i].events);
+  }
+
+  print_end();
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Cost of the tracing (see TRACING in sokol_glfw_glue.h), on the dummy backend
+// and GLFW's null platform:
+//
+//   - frame: cost of `sgg_swapchain` + `sgg_present` per frame, with the glue's
+//            own spans recorded (compare with `steady` / `glue` in `sgg_bench`),
+//   - span:  cost of an empty `sgg_trace_begin` + `sgg_trace_end` pair,
+//   - write: time to write the full rings to a Chrome trace JSON file.
+//
+// The results are printed as described in bench_common.h.
+//
+// Usage: sgg_trace_bench [--csv] [--frames N] [--out trace.json]
+
+#define SOKOL_IMPL
+#define SOKOL_DUMMY_BACKEND
+#define SGG_ENABLE_TRACE
+#include "sokol_gfx.h"
+#include "sokol_glfw_glue.h"
+
+#include "bench_common.h"
+
+#include <stdio.h>  // printf, fprintf, remove
+#include <stdlib.h> // atoi
+#include <string.h> // strcmp
+
+static void frame(void) {
+  sg_swapchain swapchain = sgg_swapchain();
+  sg_begin_pass(&(sg_pass){.swapchain = swapchain});
+  sg_end_pass();
+  sg_commit();
+  sgg_present();
+}
+
+int main(int argc, char** argv) {
+  const char* out    = "sgg_trace_bench.json";
+  bool        keep   = false;
+  int         frames = 100000;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      g_csv = true;
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      frames = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+      out  = argv[++i];
+      keep = true;
+    } else {
+      fprintf(stderr, "Usage: %s [--csv] [--frames N] [--out trace.json]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+  if (!glfwInit()) {
+    return 1;
+  }
+
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+  GLFWwindow* window = glfwCreateWindow(1280, 720, "sgg_trace_bench", NULL, NULL);
+  if (!window) {
+    fprintf(stderr, "Failed to create a window.\n");
+    glfwTerminate();
+    return 1;
+  }
+
+  sg_setup(&(sg_desc){
+    .environment = sgg_environment(&(sgg_environment_desc){.window = window}),
+  });
+
+  print_begin("dummy", "null");
+
+  for (int i = 0; i < frames / 10; i++) {
+    frame();
+  }
+
+  uint64_t start = glfwGetTimerValue();
+  for (int i = 0; i < frames; i++) {
+    frame();
+  }
+  print_record("trace", "glue", "frame", elapsed_ns(start) / frames, "ns");
+
+  start = glfwGetTimerValue();
+  for (int i = 0; i < frames; i++) {
+    sgg_trace_begin("span");
+    sgg_trace_end();
+  }
+  print_record("trace", "user", "span", elapsed_ns(start) / frames, "ns");
+
+  start   = glfwGetTimerValue();
+  bool ok = sgg_write_trace(out);
+  print_record("trace", "all", "write", elapsed_ns(start) / 1e6, "ms");
+
+  if (!keep) {
+    remove(out);
+  }
+
+  print_end();
+
+  sg_shutdown();
+  sgg_shutdown();
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  if (!ok) {
+    fprintf(stderr, "Failed to write %s.\n", out);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Sample consumer of the frame export (see FRAME EXPORT in sokol_glfw_glue.h).
+// Follows the frames published under the given name (e.g., by the example run
+// with `--export /sgg_example`), and prints once per second how many arrived,
+// how many were skipped or torn, and how old they were when picked up. With
+// `--dump`, the last frame is also written to a PPM file.
+//
+// Only needs POSIX, neither sokol_gfx nor GLFW.
+//
+// Usage: sgg_export_consumer NAME [--seconds N] [--dump frame.ppm]
+
+#if !defined(__APPLE__)
+#  define _POSIX_C_SOURCE 200809L // clock_gettime, nanosleep
+#endif
+#define SGG_EXPORT_CONSUMER_IMPL
+#include <sokol_glfw_glue.h>
+
+#include <stdio.h>  // printf, fprintf, fopen, fwrite
+#include <stdlib.h> // atoi, malloc, free
+#include <string.h> // strcmp
+#include <time.h>   // clock_gettime, nanosleep
+
+// The clock of the producer's GLFW timer.
+static uint64_t now_ns(void) {
+  struct timespec ts;
+#if defined(__APPLE__)
+  clock_gettime(CLOCK_UPTIME_RAW, &ts);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ms(int ms) {
+  struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000};
+  nanosleep(&ts, NULL);
+}
+
+static bool dump_frame(const char* path, const sgg_export_frame* frame, const uint8_t* pixels) {
+  FILE* file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+
+  fprintf(file, "P6\n%d %d\n255\n", frame->width, frame->height);
+  for (int y = 0; y < frame->height; y++) {
+    const uint8_t* row = pixels + (size_t)y * (size_t)frame->stride;
+    for (int x = 0; x < frame->width; x++) {
+      uint8_t rgb[3] = {row[x * 4 + 2], row[x * 4 + 1], row[x * 4 + 0]};
+      fwrite(rgb, 1, 3, file);
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  const char* name    = NULL;
+  const char* dump    = NULL;
+  int         seconds = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+      seconds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+      dump = argv[++i];
+    } else if (argv[i][0] == '/' && !name) {
+      name = argv[i];
+    } else {
+      name = NULL;
+      break;
+    }
+  }
+  if (!name) {
+    fprintf(stderr, "Usage: %s NAME [--seconds N] [--dump frame.ppm]\n", argv[0]);
+    return 1;
+  }
+
+  sgg_export_consumer consumer;
+  while (!sgg_open_export(&consumer, name)) {
+    sleep_ms(100);
+  }
+  printf("Opened %s\n", name);
+
+  // Copies of the frame being read and of the last complete one, for `--dump`.
+  uint8_t*         copy          = NULL;
+  uint8_t*         last          = NULL;
+  size_t           copy_capacity = 0;
+  size_t           last_capacity = 0;
+  sgg_export_frame last_frame    = {0};
+  uint64_t         start         = now_ns();
+  uint64_t         report        = start;
+  uint64_t         received      = 0;
+  uint64_t         skipped       = 0;
+  uint64_t         torn          = 0;
+  double           max_age_ms    = 0.0;
+  double           total_age_ms  = 0.0;
+
+  while (!sgg_export_closed(&consumer) && (!seconds || now_ns() - start < (uint64_t)seconds * 1000000000ull)) {
+    sgg_export_frame frame;
+    if (!sgg_acquire_export_frame(&consumer, &frame)) {
+      sleep_ms(1);
+    } else {
+      double age_ms = (double)(now_ns() - frame.timestamp_ns) / 1e6;
+
+      if (dump) {
+        size_t size = (size_t)frame.stride * (size_t)frame.height;
+        if (size > copy_capacity) {
+          free(copy);
+          copy          = (uint8_t*)malloc(size);
+          copy_capacity = size;
+        }
+        memcpy(copy, frame.pixels, size);
+      }
+
+      if (sgg_release_export_frame(&consumer)) {
+        received++;
+        skipped += frame.skipped;
+        max_age_ms = age_ms > max_age_ms ? age_ms : max_age_ms;
+        total_age_ms += age_ms;
+        last_frame = frame;
+
+        if (dump) {
+          uint8_t* swap_pixels   = last;
+          size_t   swap_capacity = last_capacity;
+          last                   = copy;
+          last_capacity          = copy_capacity;
+          copy                   = swap_pixels;
+          copy_capacity          = swap_capacity;
+        }
+      } else {
+        torn++;
+      }
+    }
+
+    uint64_t now = now_ns();
+    if (now - report >= 1000000000ull) {
+      printf(
+        "%llu frames (%dx%d), %llu skipped, %llu torn, age avg %.2f ms, max %.2f ms\n",
+        (unsigned long long)received,
+        last_frame.width,
+        last_frame.height,
+        (unsigned long long)skipped,
+        (unsigned long long)torn,
+        received ? total_age_ms / (double)received : 0.0,
+        max_age_ms);
+      report       = now;
+      received     = 0;
+      skipped      = 0;
+      torn         = 0;
+      max_age_ms   = 0.0;
+      total_age_ms = 0.0;
+    }
+  }
+
+  bool ok = true;
+  if (dump && last_frame.width > 0) {
+    ok = dump_frame(dump, &last_frame, last);
+    if (!ok) {
+      fprintf(stderr, "Failed to write %s.\n", dump);
+    }
+  }
+
+  free(copy);
+  free(last);
+  sgg_close_export(&consumer);
+  return ok ? 0 : 1;
+}
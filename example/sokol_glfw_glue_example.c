@@ -1,14 +1,25 @@
+#if defined(__linux__)
+#  define _POSIX_C_SOURCE 200809L // shm_open, ftruncate
+#endif
 #define SOKOL_IMPL
 #if defined(__APPLE__)
 #  define SOKOL_METAL
 #elif defined(_WIN32)
 #  define SOKOL_D3D11
+#else
+#  define SOKOL_GLCORE
+#endif
+#if !defined(_WIN32)
+#  define SGG_ENABLE_EXPORT
 #endif
 #include <sokol_gfx.h>
 #include <sokol_log.h>
 
 #include <sokol_glfw_glue.h>
 
+#include <stdio.h>  // printf
+#include <string.h> // strcmp
+
 #include "shaders.h"
 
 static void render_frame(GLFWwindow* window, int width, int height) {
@@ -36,27 +47,46 @@ static void render_frame(GLFWwindow* window, int width, int height) {
 }
 
 int main(int argc, char** argv) {
-  (void)argc;
-  (void)argv;
+  // `--startup` prints the time to the first frame and quits, `--sync` creates
+  // the device in `sgg_environment`, instead of alongside the window, and
+  // `--export NAME` publishes the frames to `sgg_export_consumer`.
+  bool        startup     = false;
+  bool        sync        = false;
+  const char* export_name = NULL;
+  for (int i = 1; i < argc; i++) {
+    startup = startup || strcmp(argv[i], "--startup") == 0;
+    sync    = sync || strcmp(argv[i], "--sync") == 0;
+    if (strcmp(argv[i], "--export") == 0 && i + 1 < argc) {
+      export_name = argv[++i];
+    }
+  }
 
   glfwInit();
 
+  uint64_t start = glfwGetTimerValue();
+  if (!sync) {
+    sgg_environment_begin_async();
+  }
+
   glfwDefaultWindowHints();
+#if defined(SOKOL_GLCORE)
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#else
   glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+#endif
   glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
 
   GLFWwindow* window = glfwCreateWindow(320, 320, "Sokol-GLFW Glue Test", 0, 0);
   glfwSetFramebufferSizeCallback(window, render_frame);
 
-  int max_monitor_width, max_monitor_height;
-  sgg_max_monitor_size(&max_monitor_width, &max_monitor_height);
-
   sg_setup(&(sg_desc){
     .environment = sgg_environment(&(sgg_environment_desc){
-      .window                    = window,
-      .backbuffer_min_width      = max_monitor_width,
-      .backbuffer_min_height     = max_monitor_height,
-      .backbuffer_never_downsize = true,
+      .window                 = window,
+      .backbuffer_fit_monitor = true,
     }),
     .logger.func = slog_func,
   });
@@ -66,12 +96,34 @@ int main(int argc, char** argv) {
   });
   glfwSetWindowUserPointer(window, &pipeline);
 
+#if defined(SGG_ENABLE_EXPORT)
+  if (export_name) {
+    // Sized for the largest monitor, so that the shared memory never grows.
+    int max_width, max_height;
+    sgg_max_monitor_size(&max_width, &max_height);
+    if (!sgg_begin_export(&(sgg_export_desc){.name = export_name, .max_width = max_width, .max_height = max_height})) {
+      printf("Failed to export the frames to %s\n", export_name);
+    }
+  }
+#else
+  if (export_name) {
+    printf("The frame export isn't supported on this platform\n");
+  }
+#endif
+
   while (!glfwWindowShouldClose(window) && glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS) {
+    sgg_wait_for_frame();
     glfwPollEvents();
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
     render_frame(window, width, height);
+
+    if (startup) {
+      double ms = (double)(glfwGetTimerValue() - start) * 1000.0 / (double)glfwGetTimerFrequency();
+      printf("First frame after %.1f ms (%s device creation)\n", ms, sync ? "synchronous" : "asynchronous");
+      break;
+    }
   }
 
   sg_shutdown();
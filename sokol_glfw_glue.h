@@ -11,10 +11,24 @@
 // before you include this file in *one* C or C++ file to create the
 // implementation.
 //
+// With the SOKOL_METAL backend, the sokol_gfx implementation has to be in the
+// same file (e.g., `SOKOL_IMPL` for both), as the readback copies are recorded
+// on sokol_gfx's command queue.
+//
 // In the same place, define one of the following to select the rendering
 // backend (the backends not listed here are not supported at the moment):
 //   #define SOKOL_D3D11
 //   #define SOKOL_METAL
+//   #define SOKOL_GLCORE
+//   #define SOKOL_DUMMY_BACKEND
+//
+// The dummy backend makes no graphics API calls at all, it only does the
+// bookkeeping (backbuffer size, number of resizes and presents). It's meant
+// for profiling the CPU cost of the glue and of sokol_gfx itself. Combined with
+// GLFW's null platform, it runs on headless machines:
+//
+//   glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+//   glfwInit();
 //
 // I.e., for the macOS, it could look like this:
 //
@@ -44,6 +58,15 @@
 //
 //     GLFWwindow* window = glfwCreateWindow(...);
 //
+//   With the SOKOL_GLCORE backend, the window has to own an OpenGL context
+//   instead (sgg_environment makes it current on the calling thread):
+//
+//     glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
+//     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+//     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+//     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+//     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+//
 // - when setting up sokol_gfx, use the sgg_environment function to get the
 //   environment descriptor, and pass it to the sg_setup function:
 //
@@ -58,6 +81,12 @@
 //   The window is the only required parameter in the sgg_environment_desc
 //   struct.
 //
+//   sgg_environment (and sgg_make_context) installs GLFW framebuffer size,
+//   content scale and window position callbacks (and a monitor callback) to
+//   track the window size and monitor, so that sgg_swapchain doesn't have to
+//   query them on every frame. Any such callbacks set before are still called,
+//   but don't set them after, as they'd replace the glue's ones.
+//
 // - when rendering, use the sgg_swapchain function to get the swapchain
 //   descriptor, and pass it to the sg_begin_pass function:
 //
@@ -82,6 +111,439 @@
 //     glfwDestroyWindow(window);
 //
 //
+// STARTUP
+// =======
+// Creating the device can take tens to hundreds of milliseconds (e.g.,
+// `D3D11CreateDevice` with the debug layer, or `MTLCreateSystemDefaultDevice`).
+// To keep it off the time to the first frame, start it on a background thread
+// with `sgg_environment_begin_async` before creating the window, and only call
+// `sgg_environment` once the window and the assets are ready:
+//
+//     glfwInit();
+//     sgg_environment_begin_async();
+//
+//     GLFWwindow* window = glfwCreateWindow(...);
+//     // ... load assets ...
+//
+//     sg_setup(&(sg_desc){
+//       .environment = sgg_environment(&(sgg_environment_desc){
+//         .window = window,
+//       }),
+//     });
+//
+// `sgg_environment` waits for the device, and creates the swapchain on the
+// calling thread, as before. With the SOKOL_GLCORE backend, the device is the
+// window's context, so nothing is created ahead, and the calls are harmless.
+//
+//
+// MULTIPLE WINDOWS
+// ================
+// The device is created once per process, in `sgg_environment`, together with
+// the swapchain of the window passed there (the default context). Every other
+// window gets its own swapchain sharing that device, by creating a context:
+//
+//     sgg_context ctx = sgg_make_context(&(sgg_environment_desc){
+//       .window = other_window,
+//     });
+//
+// Most of the functions (`sgg_swapchain`, `sgg_present`, `sgg_set_present_mode`)
+// operate on the current context, which is switched with `sgg_set_context`:
+//
+//     sgg_set_context(ctx);
+//     sg_begin_pass(&(sg_pass){.swapchain = sgg_swapchain()});
+//     // ...
+//     sgg_set_context(sgg_default_context());
+//     sg_begin_pass(&(sg_pass){.swapchain = sgg_swapchain()});
+//     // ...
+//     sg_commit();
+//     sgg_present_all();
+//
+// `sgg_present_all` presents every window whose swapchain was used since its
+// last present, and only the last one of them waits for the vertical blank.
+//
+// With the SOKOL_GLCORE backend, the other windows must share their OpenGL
+// context with the default one (pass the default window as the `share`
+// argument of `glfwCreateWindow`).
+//
+// Call `sgg_destroy_context` before destroying its window. The default context
+// is destroyed by `sgg_shutdown`.
+//
+//
+// RENDER THREAD
+// =============
+// GLFW has to handle the events on the main thread, and with everything on one
+// thread, rendering blocks event handling and vice versa (e.g., in the modal
+// live resize loops). With `render_thread` set in the sgg_environment_desc,
+// the device and swapchains are handed over to a dedicated render thread, and
+// the window size changes reach it through a lock-free queue:
+//
+//     // Main thread.
+//     sg_environment env = sgg_environment(&(sgg_environment_desc){
+//       .window        = window,
+//       .render_thread = true,
+//     });
+//     // ... start the render thread ...
+//     while (!glfwWindowShouldClose(window)) {
+//       glfwWaitEvents();
+//     }
+//     // ... stop and join the render thread ...
+//     sgg_shutdown();
+//
+//     // Render thread.
+//     sgg_render_thread_begin();
+//     sg_setup(&(sg_desc){.environment = env});
+//     while (running) {
+//       sg_begin_pass(&(sg_pass){.swapchain = sgg_swapchain()});
+//       // ...
+//       sg_commit();
+//       sgg_present();
+//     }
+//     sg_shutdown();
+//     sgg_render_thread_end();
+//
+// In this mode, all functions except `sgg_environment`, `sgg_make_context`,
+// `sgg_destroy_context` and `sgg_shutdown` have to be called from the render
+// thread, and the contexts should be created before it starts. The GLFW
+// callbacks chained by the glue are still called on the main thread.
+//
+//
+// ADAPTIVE RESOLUTION
+// ===================
+// With `adaptive_resolution` set, `sgg_swapchain` hands out a swapchain smaller
+// than the window when the frames take longer than `adaptive_target_ms`, and
+// goes back up when there's headroom. The rendered frame is scaled up to the
+// window when presenting:
+//
+//   - D3D11: the swapchain stretches its source region (`SetSourceSize`) over
+//     the window, so the buffers aren't reallocated when the scale changes.
+//   - Metal: the drawables are resized, and the layer stretches them.
+//   - OpenGL: the frame is rendered into an offscreen framebuffer, which is
+//     blitted to the window with linear filtering.
+//
+// The scale moves in steps of 1/20. By default, the controller measures the
+// interval between presents. With vsync on, that doesn't go below the refresh
+// interval, so within the hysteresis band, the controller probes one step up
+// every now and then, and backs off (for longer each time) if the frames don't
+// fit anymore. Apps measuring the GPU time can pass it in with
+// `sgg_report_frame_time` instead. Use `sgg_render_scale` to adjust, e.g., the
+// UI scale.
+//
+//
+// IDLE PRESENTATION
+// =================
+// Mostly static apps don't have to render continuously. Every context keeps
+// track of whether its window needs a new frame. It's marked so by resizes,
+// content scale changes, refresh requests from the window system, and
+// `sgg_invalidate`. With `redraw_on_input` set, any keyboard, mouse, focus or
+// drop input marks it too. `sgg_frame_needed` returns whether that happened
+// since the last `sgg_swapchain`, unless the window is minimized, zero-sized or
+// occluded. `sgg_wait_events` handles the GLFW events, and blocks while none
+// of the windows needs a frame:
+//
+//     while (!glfwWindowShouldClose(window)) {
+//       sgg_wait_events(1.0);
+//       if (sgg_frame_needed()) {
+//         sg_begin_pass(&(sg_pass){.swapchain = sgg_swapchain()});
+//         // ...
+//         sg_commit();
+//         sgg_present();
+//       }
+//     }
+//
+// Apps running an animation call `sgg_invalidate` on every frame while it lasts.
+//
+// Occlusion is reported by DXGI (`DXGI_STATUS_OCCLUDED`) with the SOKOL_D3D11
+// backend, and by the window's occlusion state with the SOKOL_METAL backend.
+// While occluded, the D3D11 frames are only tested, not presented, and with the
+// SOKOL_GLCORE backend, the frames of minimized windows aren't swapped, as
+// neither would wait for the vertical blank. The timeout of `sgg_wait_events`
+// bounds how late the end of the D3D11 occlusion is noticed.
+//
+// In the render thread mode, the main thread keeps waiting for the events with
+// `glfwWaitEvents`, and the render thread polls `sgg_frame_needed`.
+//
+//
+// PARTIAL PRESENTATION
+// ====================
+// When only a small part of the frame changes (e.g., a blinking cursor), the
+// frame can be presented with the changed rectangles, so that the compositor
+// only updates those:
+//
+//     sgg_rect cursor = {x, y, 2, line_height};
+//     // ... render the whole frame, as usual ...
+//     sgg_present_damage(&cursor, 1);
+//
+// With the SOKOL_D3D11 backend, the rectangles are passed to `Present1` as the
+// dirty rectangles, if `partial_present` is set in the sgg_environment_desc.
+// The swapchain then uses `DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL`, as
+// `DXGI_SWAP_EFFECT_FLIP_DISCARD` (the default) doesn't support them. With the
+// SOKOL_GLCORE backend, they're passed to `eglSwapBuffersWithDamageKHR` (or
+// `..EXT`), if the window's context was created with EGL
+// (`GLFW_CONTEXT_CREATION_API` set to `GLFW_EGL_CONTEXT_API`) and the extension
+// is there. Otherwise, and with the SOKOL_METAL backend, the whole frame is
+// presented.
+//
+// Where the glue copies the frame to the window itself (the SOKOL_GLCORE
+// offscreen framebuffers, see `adaptive_resolution` and MULTIPLE WINDOWS), it
+// only copies the rectangles that changed since the window's back buffer was
+// last drawn to. These are accumulated over the last frames, as the back buffer
+// is that many frames old (`EGL_EXT_buffer_age`), and the whole frame is copied
+// when its age isn't known, or the swapchain was resized meanwhile.
+//
+//
+// FRAME PACING
+// ============
+// To keep the latency low, a frame can be started as late as possible before
+// the vertical blank it's meant for, instead of right after the previous
+// present. `sgg_next_frame_deadline` predicts the next vertical blank that the
+// frame can still make, and when to start it, and `sgg_sleep_until` waits until
+// then:
+//
+//     sgg_frame_deadline deadline = sgg_next_frame_deadline();
+//     sgg_sleep_until(deadline.wake_ms);
+//     glfwPollEvents();
+//     // ... update, render ...
+//     sgg_present();
+//
+// The vertical blanks are predicted from the refresh rate of the monitor the
+// window is on, and the phase of the past presents. The SOKOL_D3D11 and
+// SOKOL_METAL backends report the actual vblank times (`GetFrameStatistics`,
+// `presentedTime`), otherwise the times when the blocking (FIFO) presents
+// return are used. The frame cost is measured from the return of
+// `sgg_sleep_until` (or the previous present) to `sgg_present`, and averaged,
+// together with its deviation. The wake-up time leaves four deviations plus
+// `frame_deadline_margin_ms` for the GPU and the compositor on top.
+//
+// Works best with `SGG_PRESENT_MODE_FIFO` and `max_frames_in_flight` set to 1,
+// where the frame goes on screen at the predicted vblank, instead of being
+// queued behind the previous ones.
+//
+// All times are in milliseconds, as returned by `sgg_time_ms`. The clock can be
+// replaced with `clock_func`, e.g., to test the prediction with scripted
+// timestamps. The backend-reported vblank times are then ignored, and the clock
+// has to advance while `sgg_sleep_until` waits.
+//
+//
+// RESIZE SIMULATION
+// =================
+// The backbuffer sizing doesn't call GLFW or the backend, it only sees the
+// framebuffer sizes, content scales (and, with `backbuffer_fit_monitor`, the
+// monitor sizes) delivered by the GLFW callbacks, and the frames. These can be
+// recorded in a live session:
+//
+//     static sgg_window_event events[4096];
+//     sgg_begin_window_recording(events, 4096);
+//     // ... resize the window, move it between monitors ...
+//     int count = sgg_end_window_recording();
+//
+// Recorded, or scripted, events are replayed with `sgg_simulate_resize`, which
+// runs the same sizing code on a windowless context, with the time taken from
+// the events, and the backbuffer allocations only counted. It reports how many
+// reallocations, how much peak memory, and how many wasted pixels the given
+// resize policy would produce:
+//
+//     sgg_resize_sim_result result = sgg_simulate_resize(&(sgg_environment_desc){
+//       .resize_policy = SGG_RESIZE_POLICY_GROW_POW2,
+//     }, events, count);
+//
+// See also `sgg_resize_sim` in the benchmarks, which compares the policies on
+// traces stored as CSV.
+//
+//
+// STREAMING
+// =========
+// Per-frame data (e.g., dynamic vertices, or per-draw storage buffer entries)
+// can't be overwritten while the GPU may still be reading it, i.e., for
+// `sgg_frames_in_flight` frames. A ring allocator takes one buffer per frame in
+// flight, and hands out aligned slices of the current frame's one, reusing a
+// buffer only after the frame that last used it is done:
+//
+//     sg_buffer buffers[3];
+//     for (int i = 0; i < sgg_frames_in_flight(); i++) {
+//       buffers[i] = sg_make_buffer(&(sg_buffer_desc){.size = 1 << 20, ...});
+//     }
+//     sgg_ring ring = sgg_make_ring(&(sgg_ring_desc){
+//       .buffers      = buffers,
+//       .buffer_count = sgg_frames_in_flight(),
+//       .size         = 1 << 20,
+//     });
+//
+//     // Every frame:
+//     int    offset;
+//     float* data = (float*)sgg_ring_alloc(ring, sizeof(float) * 16, &offset);
+//     // ... fill the data, allocate more ...
+//     sgg_ring_flush(ring);
+//     // ... bind sgg_ring_buffer(ring) at the offsets, draw ...
+//
+// The slices are written to the CPU memory, and the whole frame's worth is
+// uploaded at once in `sgg_ring_flush`, so that the many small updates need no
+// allocation, and the buffer being written isn't in use by the GPU (which would
+// make some drivers stall or copy it).
+//
+//
+// READBACK
+// ========
+// The rendered frames can be read back without stalling on the GPU. Ask for a
+// copy of the next presented frame with `sgg_request_readback`, and keep
+// polling for it with `sgg_poll_readback` on the subsequent frames:
+//
+//     if (capture) {
+//       sgg_request_readback();
+//     }
+//     // ...
+//     sg_commit();
+//     sgg_present(); // The copy is made here.
+//
+//     sgg_readback readback;
+//     if (sgg_poll_readback(&readback)) {
+//       // ... use readback.pixels ...
+//     }
+//
+// The copies go through a ring of `SGG_READBACK_COUNT` staging buffers per
+// context, so up to that many frames can be in flight. The pixels are usually
+// ready a frame or two later, and stay valid until the next `sgg_poll_readback`.
+//
+// With the SOKOL_METAL backend, the first request only turns off the layer's
+// `framebufferOnly` flag (the drawables can't be copied from otherwise), so the
+// copy is made from the next frame's drawable.
+//
+//
+// CAPTURE
+// =======
+// With `SGG_ENABLE_CAPTURE` defined in the implementation, the presented frames
+// of a context can be recorded to a file:
+//
+//     sgg_begin_capture(&(sgg_capture_desc){
+//       .path      = "session.y4m",
+//       .format    = SGG_CAPTURE_FORMAT_I420,
+//       .container = SGG_CAPTURE_CONTAINER_Y4M,
+//     });
+//     // ... frames presented with sgg_present are recorded ...
+//     sgg_end_capture();
+//
+// The frames are read back as described above (so the context's readbacks
+// can't be used for anything else meanwhile), through a ring grown by the
+// queue's size for the length of the capture, and a background thread converts
+// them from BGRA (with SSSE3, AVX2 or NEON, if the CPU has them) and writes them
+// to the file. The calling thread only polls the readbacks and hands them over.
+// Frames that don't fit in the queue, or whose size differs from the first one,
+// are dropped (see `sgg_query_capture_stats`). Link with pthreads on Linux.
+//
+//
+// FRAME EXPORT
+// ============
+// With `SGG_ENABLE_EXPORT` defined in the implementation, the presented frames
+// of a context can be published to other processes on the same machine, through
+// a POSIX shared memory object:
+//
+//     sgg_begin_export(&(sgg_export_desc){.name = "/my_app_frames"});
+//     // ... frames presented with sgg_present are published ...
+//     sgg_end_export();
+//
+// The frames are read back as described above (so, like with the capture, the
+// context's readbacks can't be used for anything else meanwhile), and copied to
+// a ring of `SGG_EXPORT_SLOT_COUNT` slots in the shared memory, as BGRA8, top
+// row first. Nothing waits on the consumers: each slot is guarded by a sequence
+// number (odd while being written), and the consumers pick the latest published
+// frame, and check that it wasn't overwritten while they were reading it. The
+// shared memory only grows, it's sized for the largest frame so far (or for
+// `max_width` x `max_height`, which also avoids the growing, and is needed on
+// macOS, where shared memory objects can't be resized).
+//
+// The consumers include this header on its own (no sokol_gfx or GLFW needed),
+// with `SGG_EXPORT_CONSUMER_IMPL` defined in one of their files:
+//
+//     sgg_export_consumer consumer;
+//     if (sgg_open_export(&consumer, "/my_app_frames")) {
+//       sgg_export_frame frame;
+//       if (sgg_acquire_export_frame(&consumer, &frame)) {
+//         // ... read frame.pixels ...
+//         if (!sgg_release_export_frame(&consumer)) {
+//           // Overwritten meanwhile, the pixels read are torn.
+//         }
+//       }
+//       sgg_close_export(&consumer);
+//     }
+//
+// See `example/sgg_export_consumer.c`. Both sides need POSIX 2008 (e.g., define
+// `_POSIX_C_SOURCE` to `200809L` before any include in strict C99 mode), and on
+// glibc older than 2.34, linking with `-lrt`. Not available on Windows.
+//
+//
+// HEADLESS
+// ========
+// With `headless` set in the sgg_environment_desc, the same frame code runs
+// on machines without any display, e.g., for batch rendering on servers. The
+// window only provides the (fixed) size and the clock, so it's meant to be
+// created on GLFW's null platform, without a client API:
+//
+//     glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+//     glfwInit();
+//     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+//     GLFWwindow* window = glfwCreateWindow(256, 256, "", NULL, NULL);
+//
+//     sg_environment env = sgg_environment(&(sgg_environment_desc){
+//       .window   = window,
+//       .headless = true,
+//     });
+//     if (!sgg_is_valid()) {
+//       // ... no usable EGL, bail out ...
+//     }
+//     sg_setup(&(sg_desc){.environment = env});
+//     for (int i = 0; i < frame_count; i++) {
+//       sg_begin_pass(&(sg_pass){.swapchain = sgg_swapchain()});
+//       // ...
+//       sg_end_pass();
+//       sg_commit();
+//       sgg_request_readback();
+//       sgg_present();
+//       // ... sgg_poll_readback ...
+//     }
+//
+// `sgg_swapchain` returns an offscreen framebuffer, and `sgg_present` only
+// ends the frame, so the readback, capture and export work as with a window.
+//
+// With the SOKOL_GLCORE backend, the OpenGL context is created with EGL,
+// loaded from libEGL.so.1 at runtime (link `dl` with glibc older than 2.34).
+// The first display that initializes is used, out of Mesa's surfaceless one
+// (`EGL_MESA_platform_surfaceless`, rendering on the GPU or with llvmpipe),
+// the first EGL device (`EGL_EXT_platform_device`, e.g., NVIDIA), and the
+// default one. The context is OpenGL 4.3 or 4.1 core profile, without any
+// surface (`EGL_KHR_surfaceless_context`), or with a 1x1 pbuffer. With the
+// dummy backend, nothing changes. The SOKOL_D3D11 and SOKOL_METAL backends,
+// and other contexts (`sgg_make_context`) aren't supported.
+//
+// If no display or context can be created, `sgg_environment` returns a zeroed
+// descriptor, hence the `sgg_is_valid` check before `sg_setup`.
+//
+//
+// TRACING
+// =======
+// With `SGG_ENABLE_TRACE` defined in the implementation, the glue records the
+// begin and end of `sgg_swapchain` (split into the size query, the backbuffer
+// resize and the drawable acquisition) and `sgg_present`, together with the
+// spans marked by the application:
+//
+//     sgg_trace_begin("update");
+//     // ...
+//     sgg_trace_end();
+//
+// Each thread records into its own preallocated ring of
+// `SGG_TRACE_EVENT_COUNT` events, without locks or allocations, so that the
+// tracing costs a few tens of nanoseconds per event and can stay on in release
+// builds. The rings keep the latest events, and are written as Chrome trace
+// JSON (viewable in Perfetto or `chrome://tracing`) with `sgg_write_trace`, or
+// in `sgg_shutdown`, if `trace_path` is set:
+//
+//     if (frame_ms > 50.0) {
+//       sgg_write_trace("hitch.json");
+//     }
+//
+// Threads are numbered in the order they record their first event, and only the
+// first `SGG_TRACE_MAX_THREADS` ones are traced. Without `SGG_ENABLE_TRACE`,
+// `sgg_trace_begin` and `sgg_trace_end` do nothing.
+//
+//
 // LICENSE
 // =======
 // MIT License
@@ -107,6 +569,7 @@
 // SOFTWARE.
 
 #include <stdbool.h> // bool
+#include <stdint.h>  // uint32_t
 
 #ifdef __cplusplus
 extern "C" {
@@ -118,7 +581,113 @@ struct sg_environment;
 
 struct sg_swapchain;
 
-// TODO : Add support for depth buffer, MSAA, etc., as needed.
+struct sg_buffer;
+
+// Capacity of the per-context queue of window events passed to the render thread
+// (see `render_thread`). Must be a power of two.
+#ifndef SGG_EVENT_QUEUE_SIZE
+#  define SGG_EVENT_QUEUE_SIZE 64
+#endif
+
+// Maximum number of contexts (i.e., windows), including the default one.
+#ifndef SGG_MAX_CONTEXTS
+#  define SGG_MAX_CONTEXTS 8
+#endif
+
+// Maximum number of ring allocators (see `sgg_make_ring`).
+#ifndef SGG_MAX_RINGS
+#  define SGG_MAX_RINGS 16
+#endif
+
+// Handle of a per-window context. Zero ID is invalid, and so are the IDs of
+// destroyed contexts, even once their slot is reused.
+typedef struct sgg_context {
+  uint32_t id;
+} sgg_context;
+
+// Handle of a ring allocator. Zero ID is invalid.
+typedef struct sgg_ring {
+  uint32_t id;
+} sgg_ring;
+
+// Format of the depth-stencil buffer allocated alongside the swapchain.
+typedef enum sgg_depth_format {
+  SGG_DEPTH_FORMAT_NONE,          // No depth-stencil buffer.
+  SGG_DEPTH_FORMAT_DEPTH,         // Matches `SG_PIXELFORMAT_DEPTH`.
+  SGG_DEPTH_FORMAT_DEPTH_STENCIL, // Matches `SG_PIXELFORMAT_DEPTH_STENCIL`.
+} sgg_depth_format;
+
+// Policy of choosing the backbuffer size when the window is resized.
+typedef enum sgg_resize_policy {
+  // The backbuffer matches the window size exactly (respecting the minimum size
+  // and downsizing rules).
+  SGG_RESIZE_POLICY_EXACT,
+
+  // The backbuffer grows in power-of-two steps (64, 128, 256, ...).
+  SGG_RESIZE_POLICY_GROW_POW2,
+
+  // The backbuffer grows in 1.5x steps (64, 96, 144, ...).
+  SGG_RESIZE_POLICY_GROW_1_5X,
+
+  // The backbuffer size is chosen by `resize_func`.
+  SGG_RESIZE_POLICY_CUSTOM,
+} sgg_resize_policy;
+
+// How the presented frames are synchronized with the display. Modes that the
+// backend or driver doesn't support fall back to the closest supported one (see
+// `sgg_get_present_mode`):
+//
+//   - FIFO_RELAXED falls back to FIFO.
+//   - MAILBOX falls back to FIFO (OpenGL, Metal), the only mode that's
+//     guaranteed not to tear.
+//   - IMMEDIATE falls back to MAILBOX (D3D11 without tearing support).
+typedef enum sgg_present_mode {
+  // Waits for the vertical blank, without tearing (vsync).
+  SGG_PRESENT_MODE_FIFO,
+
+  // Waits for the vertical blank, but frames that missed it are shown right
+  // away, with tearing (adaptive vsync). Only supported with the SOKOL_GLCORE
+  // backend and the `*_EXT_swap_control_tear` extensions.
+  SGG_PRESENT_MODE_FIFO_RELAXED,
+
+  // Doesn't wait, the latest frame is shown at the vertical blank, without
+  // tearing. Only supported with the SOKOL_D3D11 backend (flip model with sync
+  // interval 0).
+  SGG_PRESENT_MODE_MAILBOX,
+
+  // Doesn't wait, frames are shown right away, with tearing. Needed for
+  // variable refresh rate displays to follow the frame rate. With the
+  // SOKOL_D3D11 backend, it requires `DXGI_FEATURE_PRESENT_ALLOW_TEARING`.
+  SGG_PRESENT_MODE_IMMEDIATE,
+} sgg_present_mode;
+
+typedef struct sgg_size {
+  int width;
+  int height;
+} sgg_size;
+
+// Rectangle in swapchain pixels, with the origin at the top-left corner.
+typedef struct sgg_rect {
+  int x;
+  int y;
+  int width;
+  int height;
+} sgg_rect;
+
+// Maximum number of damage rectangles kept per frame. More are merged into
+// their bounding box. See `sgg_present_damage`.
+#ifndef SGG_MAX_DAMAGE_RECTS
+#  define SGG_MAX_DAMAGE_RECTS 16
+#endif
+
+// Custom resize policy. Gets the current backbuffer size and the required one
+// (the window size, adjusted by the minimum backbuffer size), and returns the
+// new backbuffer size, which must not be smaller than the required one.
+typedef sgg_size (*sgg_resize_func)(sgg_size current, sgg_size required, void* user_data);
+
+// Clock used by the frame pacing, returning the time in milliseconds.
+typedef double (*sgg_clock_func)(void* user_data);
+
 typedef struct sgg_environment_desc {
   // Window to render to.
   struct GLFWwindow* window;
@@ -136,421 +705,5960 @@ typedef struct sgg_environment_desc {
   // window is resizable).
   bool backbuffer_never_downsize;
 
-  // If `true`, vsync will be disabled at the start. Use `sgg_toggle_vsync` to
-  // change it at runtime.
-  bool vsync_disabled;
+  // If `true`, the backbuffer is sized for the largest framebuffer the window
+  // can have on its current monitor (the monitor's video mode), so that live
+  // resizing and going full screen don't reallocate it. Unlike pinning the
+  // minimum size to `sgg_max_monitor_size`, the size is re-planned when the
+  // window moves to another monitor, or the monitors are connected or
+  // disconnected, and follows the usual downsizing rules.
+  bool backbuffer_fit_monitor;
 
-} sgg_environment_desc;
+  // Policy of choosing the backbuffer size. See `sgg_resize_policy`.
+  sgg_resize_policy resize_policy;
 
-// Initializes the backend for a given window, and returns the sokol environment
-// descriptor used in `sg_setup` call.
-struct sg_environment sgg_environment(const sgg_environment_desc* desc);
+  // Custom resize policy, used with `SGG_RESIZE_POLICY_CUSTOM`.
+  sgg_resize_func resize_func;
 
-// Returns the swapchain descriptor used in `sg_setup` call on every frame.
-struct sg_swapchain sgg_swapchain(void);
+  // User data passed to `resize_func`.
+  void* resize_user_data;
 
-// Presents the rendered frame to the window. Needs to be called after
-// `sg_commit`.
-void sgg_present(void);
+  // Number of consecutive frames the backbuffer has to be larger than needed,
+  // before it's downsized. Set to 0 to downsize right away.
+  int backbuffer_shrink_delay_frames;
 
-// Destroys internal resources. Call this after `sg_shutdown` but before you
-// destroy the GLFW window.
-void sgg_shutdown(void);
+  // Time in milliseconds the backbuffer has to be larger than needed, before it's
+  // downsized. Set to 0 to downsize right away. If both delays are set, both
+  // have to pass.
+  double backbuffer_shrink_delay_ms;
 
-// Toggles the vsync. The initial state is determined by the `vsync_disabled`
-// field in the `sgg_environment_desc` struct.
-void sgg_toggle_vsync(void);
+  // Cap on the memory of the swapchain buffers (see
+  // `sgg_frame_stats.backbuffer_bytes`) in bytes. Growth steps and the minimum
+  // backbuffer size are given up first to fit in, but the backbuffer never gets
+  // smaller than the window. Set to 0 for no cap.
+  uint64_t backbuffer_max_bytes;
 
-// Helper function to retrieve the maximum size of any of the connected monitors
-// (as per GLFW's reporting).
-void sgg_max_monitor_size(int* width, int* height);
+  // Format of the depth-stencil buffer. It's sized together with the
+  // backbuffer, so it follows the same minimum size and downsizing rules.
+  sgg_depth_format depth_format;
 
-#ifdef __cplusplus
-} // extern "C"
+  // Number of MSAA samples. Set to 0 or 1 to disable MSAA. The multisampled
+  // color buffer is resolved into the backbuffer at the end of the pass.
+  //
+  // With the SOKOL_GLCORE backend, the main window's default framebuffer is
+  // allocated by the window system, so the `GLFW_DEPTH_BITS`,
+  // `GLFW_STENCIL_BITS` and `GLFW_SAMPLES` window hints have to match these.
+  int sample_count;
 
-// C++ alias for the C function of the same name, just using a reference.
-inline struct sg_environment sgg_environment(const sgg_environment_desc& desc) {
-  return sgg_environment(&desc);
-}
+  // Number of swapchain buffers, 2 or 3. Set to 0 to use the default (2). Has
+  // no effect with the SOKOL_GLCORE backend, where it's up to the driver.
+  int swapchain_buffer_count;
 
-#endif // __cplusplus
+  // If `true`, the SOKOL_D3D11 swapchain is created with
+  // `DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL` instead of `..._FLIP_DISCARD`, so that
+  // the rectangles passed to `sgg_present_damage` reach `Present1`. Has no
+  // effect with the other backends. See PARTIAL PRESENTATION above.
+  bool partial_present;
 
-#endif // SOKOL_GLFW_GLUE_H
+  // Maximum number of frames the CPU can get ahead of the GPU / display, from 1
+  // to 3. Set to 0 to use the default (2). See `sgg_wait_for_frame`.
+  int max_frames_in_flight;
 
-// ---------------------- Implementation follows below ---------------------- //
+  // If `true`, the frames are rendered at a fraction of the window size, and
+  // scaled up to the window when presenting. The scale is chosen by a controller
+  // keeping the frame time around `adaptive_target_ms`. See ADAPTIVE RESOLUTION.
+  bool adaptive_resolution;
 
-#if defined(SOKOL_GLFW_GLUE_IMPL) || defined(SOKOL_IMPL)
+  // Frame time the adaptive resolution aims at, in milliseconds. Set to 0 to use
+  // the refresh interval of the primary monitor.
+  double adaptive_target_ms;
 
-#define SOKOL_GLFW_GLUE_IMPL_INCLUDED (1)
+  // Relative band around the target frame time in which the scale isn't
+  // changed (e.g., 0.1 for +-10 %). Set to 0 to use the default (0.1).
+  double adaptive_hysteresis;
 
-#if !(defined(SOKOL_D3D11) || defined(SOKOL_METAL))
-#  error "Please select one of the supported backends: SOKOL_D3D11 or SOKOL_METAL"
-#endif
+  // Lower bound of the render scale. Set to 0 to use the default (0.5).
+  float adaptive_min_scale;
 
-// Note: Relying on the headers that are being included from sokol_gfx.h.
+  // Upper bound of the render scale. Set to 0 to use the default (1.0).
+  float adaptive_max_scale;
 
-#ifdef SOKOL_DEBUG
-#  include <stdio.h> // printf
-#endif
+  // If `true`, the GLFW input callbacks are chained too, and any input marks the
+  // window as needing a new frame. See IDLE PRESENTATION above.
+  bool redraw_on_input;
 
-#if defined(SOKOL_D3D11)
-#  define GLFW_EXPOSE_NATIVE_WIN32
-#  include <d3d11_1.h> // DXGI*, ID3D11*, IDXGI*
-#  include <dxgi1_3.h> // DXGIGetDebugInterface1
-#  ifdef SOKOL_DEBUG
-#    include <dxgidebug.h> // ...
-#  endif
-#  ifdef _MSC_VER
-#    pragma comment(lib, "dxguid")
-#  endif
-#elif defined(SOKOL_METAL)
-#  if !__has_feature(objc_arc)
-#    error Objective-C's ARC is off. Use "-fobjc-arc" compiler flag to enable it.
-#  endif
-#  define GLFW_EXPOSE_NATIVE_COCOA
-#  import <Cocoa/Cocoa.h> // NSWindow
-#endif
+  // If `true`, the swapchain is used from a dedicated render thread, and the
+  // window events are passed to it through a lock-free queue. Only read in
+  // `sgg_environment` (all contexts use the same mode). See RENDER THREAD above.
+  bool render_thread;
 
-#define GLFW_INCLUDE_NONE
-#include <GLFW/glfw3.h>       // glfw*
-#include <GLFW/glfw3native.h> // glfwGet*Window
+  // If `true`, nothing is shown and no display is needed: the frames are
+  // rendered to an offscreen framebuffer of the window's size, and the window
+  // only stands for the size (e.g., created on GLFW's null platform). Only read
+  // in `sgg_environment`. See HEADLESS above.
+  bool headless;
 
-// clang-format off
-typedef struct {
-  sgg_environment_desc    desc;
-#if defined(SOKOL_D3D11)
-  ID3D11Device*           base_device;
-  ID3D11DeviceContext*    base_device_context;
-  ID3D11Device1*          device;
-  ID3D11DeviceContext1*   device_context;
-  IDXGISwapChain1*        swapchain;
-  DXGI_SWAP_CHAIN_DESC1   swapchain_desc;
-  ID3D11RenderTargetView* render_target_view;
-#elif defined(SOKOL_METAL)
-  CAMetalLayer*           layer;
-  id<MTLDevice>           device;
-  id<CAMetalDrawable>     drawable;
-#endif // SOKOL_* backend
-} sgg__state;
-// clang-format on
+  // Presentation mode at the start. Set to 0 to use vsync
+  // (`SGG_PRESENT_MODE_FIFO`). Use `sgg_set_present_mode` to change it at
+  // runtime.
+  sgg_present_mode present_mode;
 
-static sgg__state g_sgg_state = {0};
+  // Time reserved before the predicted vertical blank for the GPU and the
+  // compositor, in milliseconds. Set to 0 to use the default (1 ms). See FRAME
+  // PACING above.
+  double frame_deadline_margin_ms;
 
-#if defined(SOKOL_D3D11)
-// `sokol_gfx.h` doesn't define COBJMACROS before including D3D11 and DXGI
-// headers, and now it's too late.
-#  if !defined(__cplusplus) && !defined(COBJMACROS)
-#    define ID3D11Device1_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
-#    define ID3D11Device_CreateRenderTargetView(This, pResource, pDesc, ppRTView)                                             ((This)->lpVtbl->CreateRenderTargetView(This, pResource, pDesc, ppRTView))
-#    define ID3D11Device_QueryInterface(This, riid, ppvObject)                                                                ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
-#    define ID3D11Device_Release(This)                                                                                        ((This)->lpVtbl->Release(This))
-#    define ID3D11DeviceContext1_QueryInterface(This, riid, ppvObject)                                                        ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
-#    define ID3D11DeviceContext1_Release(This)                                                                                ((This)->lpVtbl->Release(This))
-#    define ID3D11DeviceContext_QueryInterface(This, riid, ppvObject)                                                         ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
-#    define ID3D11DeviceContext_Release(This)                                                                                 ((This)->lpVtbl->Release(This))
-#    define ID3D11RenderTargetView_Release(This)                                                                              ((This)->lpVtbl->Release(This))
-#    define ID3D11Texture2D_Release(This)                                                                                     ((This)->lpVtbl->Release(This))
-#    define IDXGIAdapter1_GetParent(This, riid, ppParent)                                                                     ((This)->lpVtbl->GetParent(This, riid, ppParent))
-#    define IDXGIAdapter1_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
-#    define IDXGIDevice1_Release(This)                                                                                        ((This)->lpVtbl->Release(This))
-#    define IDXGIDevice_GetParent(This, riid, ppParent)                                                                       ((This)->lpVtbl->GetParent(This, riid, ppParent))
-#    define IDXGIFactory2_CreateSwapChainForHwnd(This, pDevice, hWnd, pDesc, pFullscreenDesc, pRestrictToOutput, ppSwapChain) ((This)->lpVtbl->CreateSwapChainForHwnd(This, pDevice, hWnd, pDesc, pFullscreenDesc, pRestrictToOutput, ppSwapChain))
-#    define IDXGIFactory2_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
-#    define IDXGISwapChain1_GetBackgroundColor(This, pColor)                                                                  ((This)->lpVtbl->GetBackgroundColor(This, pColor))
-#    define IDXGISwapChain1_GetBuffer(This, Buffer, riid, ppSurface)                                                          ((This)->lpVtbl->GetBuffer(This, Buffer, riid, ppSurface))
-#    define IDXGISwapChain1_Present(This, SyncInterval, Flags)                                                                ((This)->lpVtbl->Present(This, SyncInterval, Flags))
-#    define IDXGISwapChain1_Release(This)                                                                                     ((This)->lpVtbl->Release(This))
-#    define IDXGISwapChain1_ResizeBuffers(This, BufferCount, Width, Height, NewFormat, SwapChainFlags)                        ((This)->lpVtbl->ResizeBuffers(This, BufferCount, Width, Height, NewFormat, SwapChainFlags))
-#  endif // !__cplusplus && !COBJMACROS
+  // Clock used by the frame pacing. Set to `NULL` to use GLFW's timer. Only
+  // read in `sgg_environment`.
+  sgg_clock_func clock_func;
 
-static void sgg__platform_init(sgg__state* state) {
-  D3D_FEATURE_LEVEL    feature_levels[] = {D3D_FEATURE_LEVEL_11_1};
-  ID3D11Device*        base_device;
-  ID3D11DeviceContext* base_device_context;
+  // User data passed to `clock_func`.
+  void* clock_user_data;
 
-  UINT device_flags = 0;
-  device_flags |= D3D11_CREATE_DEVICE_SINGLETHREADED; // TODO : Runtime configurable ?
-  device_flags |= D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-#  ifdef SOKOL_DEBUG
-  device_flags |= D3D11_CREATE_DEVICE_DEBUG; // TODO : Runtime configurable ?
-#  endif
+  // Path of the Chrome trace JSON file written in `sgg_shutdown`. Set to `NULL`
+  // to not write any. Must stay valid until then. Only read in
+  // `sgg_environment`, and needs `SGG_ENABLE_TRACE`. See TRACING above.
+  const char* trace_path;
 
-  HRESULT hr = D3D11CreateDevice(
-    NULL,
-    D3D_DRIVER_TYPE_HARDWARE,
-    NULL,
-    device_flags,
-    feature_levels,
-    1,
-    D3D11_SDK_VERSION,
-    &base_device,
-    NULL,
-    &base_device_context);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+} sgg_environment_desc;
 
-  ID3D11Device1* device;
-  hr = ID3D11Device_QueryInterface(base_device, &IID_ID3D11Device1, (void**)(&device));
-  SOKOL_ASSERT(SUCCEEDED(hr));
+typedef struct sgg_ring_desc {
+  // Buffers the slices are handed out of, one per frame, in turns. There must
+  // be at least `sgg_frames_in_flight` of them (at most 3), each `size` bytes
+  // large, and updatable with `sg_update_buffer` (e.g., `SG_USAGE_DYNAMIC`).
+  // They aren't destroyed with the ring.
+  const struct sg_buffer* buffers;
+  int                     buffer_count;
 
-  ID3D11DeviceContext1* device_context;
-  hr = ID3D11DeviceContext_QueryInterface(base_device_context, &IID_ID3D11DeviceContext1, (void**)&device_context);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+  // Space available per frame, in bytes. Can't exceed the size of any of the
+  // buffers.
+  int size;
 
-  IDXGIDevice1* dxgi_device;
-  hr = ID3D11Device_QueryInterface(device, &IID_IDXGIDevice1, (void**)&dxgi_device);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+  // Alignment of the slices' offsets, a power of two. Set to 0 to use the
+  // default (256, enough for the uniform and storage buffer bindings on all
+  // backends).
+  int alignment;
+} sgg_ring_desc;
 
-  IDXGIAdapter1* adapter;
-  hr = IDXGIDevice_GetParent(dxgi_device, &IID_IDXGIAdapter1, (void**)&adapter);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+// Number of staging buffers per context used by `sgg_request_readback`.
+#ifndef SGG_READBACK_COUNT
+#  define SGG_READBACK_COUNT 3
+#endif
+
+// Backbuffer contents returned by `sgg_poll_readback`.
+typedef struct sgg_readback {
+  // BGRA8 pixels, valid until the next `sgg_poll_readback` call.
+  const void* pixels;
+
+  int width;
+  int height;
+
+  // Distance between the starts of two consecutive rows, in bytes.
+  int row_pitch;
+
+  // If `true`, the first row is the bottom one (SOKOL_GLCORE).
+  bool bottom_up;
+
+  // Number of frames presented by the context before the read back one.
+  uint64_t frame_index;
+} sgg_readback;
+
+// Pixel format of the captured frames.
+typedef enum sgg_capture_format {
+  SGG_CAPTURE_FORMAT_RGBA, // 8 bits per channel, interleaved.
+  SGG_CAPTURE_FORMAT_I420, // BT.601 limited range Y plane, then 2x2 subsampled U and V planes.
+} sgg_capture_format;
+
+// File format of the capture.
+typedef enum sgg_capture_container {
+  SGG_CAPTURE_CONTAINER_RAW, // Frames stored back to back, with no header.
+  SGG_CAPTURE_CONTAINER_Y4M, // YUV4MPEG2 stream, `SGG_CAPTURE_FORMAT_I420` only.
+} sgg_capture_container;
+
+// Implementation of the pixel conversion.
+typedef enum sgg_pixel_kernel {
+  SGG_PIXEL_KERNEL_AUTO, // The fastest one supported by the CPU.
+  SGG_PIXEL_KERNEL_SCALAR,
+  SGG_PIXEL_KERNEL_SSSE3,
+  SGG_PIXEL_KERNEL_AVX2,
+  SGG_PIXEL_KERNEL_NEON,
+} sgg_pixel_kernel;
+
+typedef struct sgg_capture_desc {
+  // Path of the output file. It's overwritten if it exists.
+  const char* path;
+
+  // Pixel format of the frames written to the file.
+  sgg_capture_format format;
+
+  // File format. See `sgg_capture_container`.
+  sgg_capture_container container;
+
+  // Frame rate stored in the Y4M header. Set to 0 to use the default (60).
+  int fps;
+
+  // Number of converted frames the writer thread can lag behind. Set to 0 to
+  // use the default (3). Each one also keeps a staging buffer of the context's
+  // readback ring.
+  int queue_size;
+
+  // Conversion kernel, mostly for benchmarking. Set to `SGG_PIXEL_KERNEL_AUTO`
+  // (the default) to pick the fastest one.
+  sgg_pixel_kernel kernel;
+} sgg_capture_desc;
+
+typedef struct sgg_capture_stats {
+  // Number of frames written to the file so far.
+  uint64_t frames_written;
+
+  // Number of presented frames that didn't make it to the file.
+  uint64_t frames_dropped;
+
+  // Number of bytes written to the file so far, including the headers.
+  uint64_t bytes_written;
+} sgg_capture_stats;
+
+// Number of frames in the shared memory ring of the frame export.
+#define SGG_EXPORT_SLOT_COUNT 3
+
+// First field of the frame export's shared memory ("SGGE").
+#define SGG_EXPORT_MAGIC 0x45474753u
+
+// Version of the frame export's shared memory layout.
+#define SGG_EXPORT_VERSION 1
+
+// Pixel format of the exported frames.
+typedef enum sgg_export_format {
+  SGG_EXPORT_FORMAT_BGRA8 = 1, // 8 bits per channel, interleaved.
+} sgg_export_format;
+
+typedef struct sgg_export_desc {
+  // Name of the POSIX shared memory object, starting with a slash (e.g.,
+  // "/my_app_frames"). An existing one is replaced. Must stay valid until
+  // `sgg_end_export`.
+  const char* name;
+
+  // Size of the largest expected frame, to allocate the shared memory for up
+  // front. Set to 0 to use the default (size of the first frame, growing later
+  // as needed).
+  int max_width;
+  int max_height;
+} sgg_export_desc;
+
+typedef struct sgg_export_stats {
+  // Number of frames published to the shared memory so far.
+  uint64_t frames_published;
+
+  // Number of presented frames that didn't make it to the shared memory.
+  uint64_t frames_dropped;
+} sgg_export_stats;
+
+// One frame of the frame export's shared memory. Written by the producer only,
+// the consumers have to check `sequence` before and after reading the rest.
+typedef struct sgg_export_slot {
+  // Odd while the slot is being written, incremented twice per frame.
+  uint64_t sequence;
+
+  // Number of frames presented by the context before this one.
+  uint64_t frame_id;
+
+  // Time the frame was published, in nanoseconds of GLFW's timer (i.e.,
+  // `CLOCK_MONOTONIC` on Linux, and `mach_absolute_time` on macOS).
+  uint64_t timestamp_ns;
+
+  // Offset of the pixels from the start of the shared memory.
+  uint64_t offset;
+
+  int32_t  width;
+  int32_t  height;
+  int32_t  stride; // Distance between the starts of two rows, in bytes.
+  uint32_t format; // `sgg_export_format`.
+} sgg_export_slot;
+
+// Start of the frame export's shared memory.
+typedef struct sgg_export_header {
+  uint32_t magic;   // `SGG_EXPORT_MAGIC`, written last.
+  uint32_t version; // `SGG_EXPORT_VERSION`.
+
+  // Size of the shared memory, in bytes. It only grows.
+  uint64_t size;
+
+  // Number of frames published so far. The latest one is in the slot
+  // `(frame_count - 1) % SGG_EXPORT_SLOT_COUNT`.
+  uint64_t frame_count;
+
+  // Nonzero once the producer has called `sgg_end_export`.
+  uint32_t closed;
+  uint32_t reserved;
+
+  sgg_export_slot slots[SGG_EXPORT_SLOT_COUNT];
+} sgg_export_header;
+
+// Frame returned by `sgg_acquire_export_frame`.
+typedef struct sgg_export_frame {
+  // Pixels in the shared memory, top row first, valid until the next
+  // `sgg_acquire_export_frame` or `sgg_close_export` call.
+  const void* pixels;
+
+  int               width;
+  int               height;
+  int               stride;
+  sgg_export_format format;
+  uint64_t          frame_id;
+  uint64_t          timestamp_ns;
+
+  // Number of frames published since the previously acquired one, that the
+  // consumer didn't get to see.
+  uint64_t skipped;
+} sgg_export_frame;
+
+// Consumer side of a frame export, opened with `sgg_open_export`.
+typedef struct sgg_export_consumer {
+  int                      fd;
+  const sgg_export_header* header;
+  uint64_t                 size;
+  uint64_t                 frame_count;
+  uint64_t                 sequence;
+  int                      slot;
+} sgg_export_consumer;
+
+// Number of frames kept for the rolling frame statistics.
+#ifndef SGG_FRAME_STATS_HISTORY
+#  define SGG_FRAME_STATS_HISTORY 240
+#endif
+
+// CPU time statistics of one phase of the frame, in milliseconds.
+typedef struct sgg_timing_stats {
+  double last_ms;
+  double min_ms;
+  double avg_ms;
+  double p99_ms;
+} sgg_timing_stats;
+
+// Frame statistics of a context. Timings are rolling over the last
+// `SGG_FRAME_STATS_HISTORY` samples. Timings are only collected if
+// `SGG_ENABLE_FRAME_STATS` is defined in the implementation, otherwise they're
+// zero.
+typedef struct sgg_frame_stats {
+  // Drawable acquisition in `sgg_swapchain` (e.g., Metal's `nextDrawable`).
+  sgg_timing_stats acquire;
+
+  // `sgg_present`.
+  sgg_timing_stats present;
+
+  // Backbuffer (re)allocation, including the depth and MSAA buffers. The
+  // samples are per resize, not per frame.
+  sgg_timing_stats resize;
+
+  // Number of presented frames.
+  uint64_t frame_count;
+
+  // Number of backbuffer (re)allocations.
+  uint64_t resize_count;
+
+  // Estimated memory taken by all swapchain buffers, including the depth and
+  // MSAA buffers, in bytes.
+  uint64_t backbuffer_bytes;
+} sgg_frame_stats;
+
+// Number of events kept per thread for the tracing. Must be a power of two.
+#ifndef SGG_TRACE_EVENT_COUNT
+#  define SGG_TRACE_EVENT_COUNT 16384
+#endif
+
+// Maximum number of threads recording trace events.
+#ifndef SGG_TRACE_MAX_THREADS
+#  define SGG_TRACE_MAX_THREADS 8
+#endif
+
+// Predicted timing of the next frame of a context, in milliseconds of
+// `sgg_time_ms`. See FRAME PACING.
+typedef struct sgg_frame_deadline {
+  // Predicted time of the next vertical blank that the frame can still make.
+  double vblank_ms;
+
+  // Recommended time to start the frame. Never earlier than the current time.
+  double wake_ms;
+
+  // Refresh interval of the window's monitor.
+  double refresh_interval_ms;
+
+  // Average frame cost, from the start of the frame to `sgg_present`.
+  double frame_cost_ms;
+} sgg_frame_deadline;
+
+// Type of a recorded (or scripted) window event. See RESIZE SIMULATION.
+typedef enum sgg_window_event_type {
+  SGG_WINDOW_EVENT_FRAME,            // A frame was rendered (`sgg_swapchain`).
+  SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE, // The framebuffer was resized.
+  SGG_WINDOW_EVENT_CONTENT_SCALE,    // The content scale changed.
+  SGG_WINDOW_EVENT_MONITOR,          // The window moved to another monitor (both of the above).
+  SGG_WINDOW_EVENT_MONITOR_SIZE,     // The largest framebuffer size on the window's monitor changed.
+} sgg_window_event_type;
+
+typedef struct sgg_window_event {
+  sgg_window_event_type type;
+
+  // Time since the start of the recording, in milliseconds.
+  double time_ms;
+
+  // New framebuffer size (`SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE`, `..._MONITOR`).
+  int width;
+  int height;
+
+  // New content scale (`SGG_WINDOW_EVENT_CONTENT_SCALE`, `..._MONITOR`).
+  float x_scale;
+  float y_scale;
+} sgg_window_event;
+
+// Outcome of replaying window events with `sgg_simulate_resize`.
+typedef struct sgg_resize_sim_result {
+  // Number of simulated frames.
+  uint64_t frames;
+
+  // Number of backbuffer (re)allocations, including the first one.
+  uint64_t reallocations;
+
+  // Largest memory taken by the swapchain buffers (see
+  // `sgg_frame_stats.backbuffer_bytes`), in bytes.
+  uint64_t peak_backbuffer_bytes;
+
+  // Backbuffer pixels outside of the window, summed over all frames.
+  uint64_t wasted_pixels;
+
+  // Backbuffer pixels, summed over all frames.
+  uint64_t backbuffer_pixels;
+} sgg_resize_sim_result;
+
+// Starts creating the device on a background thread, so that it overlaps with
+// the window creation and asset loading. Call it before `sgg_environment`,
+// which then only waits for the device and creates the swapchain. See STARTUP
+// above.
+void sgg_environment_begin_async(void);
+
+// Blocks until the device creation started by `sgg_environment_begin_async` is
+// done. Called by `sgg_environment`, so calling it is optional (e.g., to see
+// how long the wait is).
+void sgg_environment_wait(void);
+
+// Initializes the backend for a given window, and returns the sokol environment
+// descriptor used in `sg_setup` call. If the backend can't be initialized
+// (e.g., there's no usable EGL in the headless mode), returns a zeroed
+// descriptor, and `sgg_is_valid` returns `false`.
+struct sg_environment sgg_environment(const sgg_environment_desc* desc);
+
+// Returns `true` between a successful `sgg_environment` and `sgg_shutdown`.
+bool sgg_is_valid(void);
+
+// Returns the swapchain descriptor of the current context, used in
+// `sg_begin_pass` call on every frame.
+struct sg_swapchain sgg_swapchain(void);
+
+// Presents the rendered frame to the window of the current context. Needs to
+// be called after `sg_commit`.
+void sgg_present(void);
+
+// Presents the rendered frame like `sgg_present`, but tells the compositor that
+// only the given rectangles changed since the previous frame. The whole frame
+// still has to be rendered. Passing no rectangles is the same as `sgg_present`.
+// See PARTIAL PRESENTATION above.
+void sgg_present_damage(const sgg_rect* rects, int count);
+
+// Blocks until the current context can accept a new frame without exceeding its
+// `max_frames_in_flight`. Call this at the start of the frame, before sampling
+// the input (e.g., before `glfwPollEvents`), so that the CPU stalls at a known
+// point, and not in `sgg_swapchain` or `sgg_present`. Calling it is optional,
+// and calling it again in the same frame doesn't wait again.
+void sgg_wait_for_frame(void);
+
+// Returns the index of the frame being rendered by the current context, i.e.,
+// the number of frames it has presented so far.
+uint64_t sgg_frame_index(void);
+
+// Returns the number of frames of the current context the GPU can still be
+// working on, i.e., for how many frames the per-frame data has to be kept
+// (`max_frames_in_flight`). See STREAMING above.
+int sgg_frames_in_flight(void);
+
+// Creates a ring allocator handing out slices of the given buffers, following
+// the frames of the current context. See STREAMING above.
+sgg_ring sgg_make_ring(const sgg_ring_desc* desc);
+
+// Destroys the ring allocator, but not its buffers.
+void sgg_destroy_ring(sgg_ring ring);
+
+// Allocates `size` bytes in the ring's buffer of the current frame. Returns the
+// memory to write the data to, valid until `sgg_ring_flush`, and stores the
+// slice's offset in the buffer to `offset`. Returns `NULL` if the buffer is
+// full. The first allocation of a frame calls `sgg_wait_for_frame`.
+void* sgg_ring_alloc(sgg_ring ring, int size, int* offset);
+
+// Returns the ring's buffer of the current frame, which the offsets returned by
+// `sgg_ring_alloc` point into.
+struct sg_buffer sgg_ring_buffer(sgg_ring ring);
+
+// Uploads the slices allocated in the current frame to the buffer, with a
+// single `sg_update_buffer`. Call it after the frame's last `sgg_ring_alloc`,
+// and before the draws using the slices.
+void sgg_ring_flush(sgg_ring ring);
+
+// Presents the rendered frame to all windows whose swapchain was retrieved
+// since their last present. Needs to be called after `sg_commit`.
+void sgg_present_all(void);
+
+// Creates a context for another window, sharing the device created in
+// `sgg_environment`. Only the window, backbuffer, resize policy, depth, MSAA,
+// frame latency, present mode, partial present and frame deadline fields are
+// used.
+sgg_context sgg_make_context(const sgg_environment_desc* desc);
+
+// Destroys the context. Call this before you destroy its GLFW window.
+void sgg_destroy_context(sgg_context ctx);
+
+// Makes the context current for the subsequent calls.
+void sgg_set_context(sgg_context ctx);
+
+// Returns the current context.
+sgg_context sgg_get_context(void);
+
+// Returns the default context, created for the window passed to
+// `sgg_environment`.
+sgg_context sgg_default_context(void);
+
+// Destroys internal resources of all contexts. Call this after `sg_shutdown` but
+// before you destroy the GLFW windows.
+void sgg_shutdown(void);
+
+// Changes the presentation mode of the current context, starting with the next
+// present. The initial mode is determined by the `present_mode` field in the
+// `sgg_environment_desc` struct.
+void sgg_set_present_mode(sgg_present_mode mode);
+
+// Returns the presentation mode the current context actually uses, i.e., the
+// requested one after the fallbacks (see `sgg_present_mode`).
+sgg_present_mode sgg_get_present_mode(void);
+
+// Takes over the device and swapchains on the calling (render) thread. Call this
+// before `sg_setup`, when `render_thread` is enabled.
+void sgg_render_thread_begin(void);
+
+// Releases the device and swapchains from the calling (render) thread. Call
+// this after `sg_shutdown`, when `render_thread` is enabled.
+void sgg_render_thread_end(void);
+
+// Marks the window of the current context as needing a new frame. See IDLE
+// PRESENTATION above.
+void sgg_invalidate(void);
+
+// Returns `true` if the window of the current context was marked as needing a
+// new frame since the last `sgg_swapchain` call, and is visible (i.e., not
+// minimized, zero-sized or occluded).
+bool sgg_frame_needed(void);
+
+// Processes the pending GLFW events. If none of the windows needs a new frame,
+// it waits for the events for at most `timeout` seconds first. Returns `true`
+// if any window needs a new frame afterwards. Main thread only, not usable in
+// the render thread mode.
+bool sgg_wait_events(double timeout);
+
+// Returns the current time of the clock used by the frame pacing (GLFW's timer,
+// unless replaced with `clock_func`), in milliseconds.
+double sgg_time_ms(void);
+
+// Predicts the next vertical blank of the current context's window that a
+// frame started now can still make, and the latest time to start it. See FRAME
+// PACING above.
+sgg_frame_deadline sgg_next_frame_deadline(void);
+
+// Sleeps until the given time (see `sgg_time_ms`), and marks the start of the
+// current context's frame for the frame cost estimate. The OS sleep is ended a
+// bit early, and the rest is spun, as the OS tends to oversleep.
+void sgg_sleep_until(double time_ms);
+
+// Returns the render scale of the current context, i.e., the ratio of the
+// swapchain size to the window size. Always 1 without `adaptive_resolution`.
+float sgg_render_scale(void);
+
+// Feeds the adaptive resolution controller of the current context with the
+// duration of the last frame in milliseconds (e.g., measured with GPU timer
+// queries). Once called, it replaces the interval between presents, which is
+// used by default.
+void sgg_report_frame_time(double ms);
+
+// Requests a copy of the frame presented next by the current context. Returns
+// `false` if all `SGG_READBACK_COUNT` staging buffers are still in flight, or
+// the context is being captured or exported. Requesting again before the
+// present has no effect.
+bool sgg_request_readback(void);
+
+// Returns the oldest requested frame of the current context, if the GPU has
+// finished copying it, and `false` otherwise (also while the context is being
+// captured or exported). Never blocks.
+bool sgg_poll_readback(sgg_readback* readback);
+
+// Starts recording the frames presented by the current context. Returns `false`
+// if the output file can't be opened, or the kernel isn't supported by the CPU.
+// Only one capture can run at a time.
+// Needs `SGG_ENABLE_CAPTURE`.
+bool sgg_begin_capture(const sgg_capture_desc* desc);
+
+// Stops the capture, waiting until the queued frames are written. Frames still
+// being copied on the GPU are dropped. Needs `SGG_ENABLE_CAPTURE`.
+void sgg_end_capture(void);
+
+// Returns the statistics of the running (or the last) capture. Needs
+// `SGG_ENABLE_CAPTURE`.
+sgg_capture_stats sgg_query_capture_stats(void);
+
+// Returns the size in bytes of a `width` x `height` frame in the given format.
+// Needs `SGG_ENABLE_CAPTURE`.
+uint64_t sgg_capture_frame_size(sgg_capture_format format, int width, int height);
+
+// Converts the pixels returned by `sgg_poll_readback` to the given format, top
+// row first, tightly packed. Returns `false` if the kernel isn't supported by
+// the CPU. Needs `SGG_ENABLE_CAPTURE`.
+bool sgg_convert_pixels(const sgg_readback* readback, sgg_capture_format format, sgg_pixel_kernel kernel, void* dst);
+
+// Starts publishing the frames presented by the current context to the shared
+// memory. Returns `false` if the shared memory can't be created. Only one export
+// can run at a time, and not on a context being captured. Needs
+// `SGG_ENABLE_EXPORT`. See FRAME EXPORT above.
+bool sgg_begin_export(const sgg_export_desc* desc);
+
+// Stops the export, and removes the shared memory object (the consumers that
+// have it open keep it until they close it). Needs `SGG_ENABLE_EXPORT`.
+void sgg_end_export(void);
+
+// Returns the statistics of the running (or the last) export. Needs
+// `SGG_ENABLE_EXPORT`.
+sgg_export_stats sgg_query_export_stats(void);
+
+// Opens the frame export published under `name` by another process. Returns
+// `false` if there's none (yet). Needs `SGG_EXPORT_CONSUMER_IMPL`.
+bool sgg_open_export(sgg_export_consumer* consumer, const char* name);
+
+// Closes the frame export. Needs `SGG_EXPORT_CONSUMER_IMPL`.
+void sgg_close_export(sgg_export_consumer* consumer);
+
+// Returns the latest frame published since the previous call, and `false` if
+// there's no new one. Never blocks the producer, nor waits for it. Needs
+// `SGG_EXPORT_CONSUMER_IMPL`.
+bool sgg_acquire_export_frame(sgg_export_consumer* consumer, sgg_export_frame* frame);
+
+// Returns `false` if the producer has started overwriting the last acquired
+// frame, i.e., the pixels read since `sgg_acquire_export_frame` can be torn.
+// Needs `SGG_EXPORT_CONSUMER_IMPL`.
+bool sgg_release_export_frame(sgg_export_consumer* consumer);
+
+// Returns `true` if the producer has ended the export. Needs
+// `SGG_EXPORT_CONSUMER_IMPL`.
+bool sgg_export_closed(const sgg_export_consumer* consumer);
+
+// Returns the frame statistics of the current context.
+sgg_frame_stats sgg_query_frame_stats(void);
+
+// Starts a span on the calling thread's trace. `name` isn't copied, so it has
+// to stay valid until the trace is written (e.g., a string literal). Does
+// nothing without `SGG_ENABLE_TRACE`. See TRACING above.
+void sgg_trace_begin(const char* name);
+
+// Ends the innermost span started on the calling thread.
+void sgg_trace_end(void);
+
+// Writes the recorded trace events of all threads to a Chrome trace JSON file.
+// Can be called from any thread, at any time, and keeps the events. Returns
+// `false` if the file can't be written, or without `SGG_ENABLE_TRACE`.
+bool sgg_write_trace(const char* path);
+
+// Starts recording the window events and frames of the current context into
+// `events`, starting with its current size and content scale. Events that don't
+// fit in `capacity` are dropped. See RESIZE SIMULATION.
+void sgg_begin_window_recording(sgg_window_event* events, int capacity);
+
+// Stops the recording, and returns the number of recorded events.
+int sgg_end_window_recording(void);
+
+// Replays the window events through the backbuffer sizing of a context created
+// with `desc`, without any window or backend. Only the backbuffer, resize policy,
+// depth, MSAA and swapchain buffer fields are used (`window` can be `NULL`).
+// Doesn't need `sgg_environment`.
+sgg_resize_sim_result sgg_simulate_resize(const sgg_environment_desc* desc, const sgg_window_event* events, int event_count);
+
+// Helper function to retrieve the maximum size of any of the connected monitors
+// (as per GLFW's reporting). See also `backbuffer_fit_monitor`, which only sizes
+// for the window's current monitor.
+void sgg_max_monitor_size(int* width, int* height);
+
+#ifdef __cplusplus
+} // extern "C"
+
+// C++ alias for the C function of the same name, just using a reference. Left
+// out without sokol_gfx (e.g., in the frame export consumers).
+#  ifdef SOKOL_GFX_INCLUDED
+inline struct sg_environment sgg_environment(const sgg_environment_desc& desc) {
+  return sgg_environment(&desc);
+}
+#  endif
+
+// C++ alias for the C function of the same name, just using a reference.
+inline sgg_context sgg_make_context(const sgg_environment_desc& desc) {
+  return sgg_make_context(&desc);
+}
+
+// C++ alias for the C function of the same name, just using a reference.
+inline sgg_ring sgg_make_ring(const sgg_ring_desc& desc) {
+  return sgg_make_ring(&desc);
+}
+
+// C++ alias for the C function of the same name, just using a reference.
+inline bool sgg_begin_capture(const sgg_capture_desc& desc) {
+  return sgg_begin_capture(&desc);
+}
+
+// C++ alias for the C function of the same name, just using a reference.
+inline bool sgg_begin_export(const sgg_export_desc& desc) {
+  return sgg_begin_export(&desc);
+}
+
+#endif // __cplusplus
+
+#endif // SOKOL_GLFW_GLUE_H
+
+// ---------------------- Implementation follows below ---------------------- //
+
+// The frame export consumer only needs POSIX, so that the consumer processes
+// don't have to build sokol_gfx and GLFW. The producer shares its helpers.
+#if defined(SGG_EXPORT_CONSUMER_IMPL) || ((defined(SOKOL_GLFW_GLUE_IMPL) || defined(SOKOL_IMPL)) && defined(SGG_ENABLE_EXPORT))
+#  ifndef SGG_EXPORT_IMPL_INCLUDED
+#    define SGG_EXPORT_IMPL_INCLUDED (1)
+
+#    if defined(_WIN32)
+#      error "The frame export needs POSIX shared memory, which isn't available on Windows"
+#    endif
+
+#    include <fcntl.h>    // O_*
+#    include <sys/mman.h> // mmap, munmap, shm_open, shm_unlink
+#    include <sys/stat.h> // fstat
+#    include <unistd.h>   // close, ftruncate
+
+#    ifndef SOKOL_ASSERT
+#      include <assert.h>
+#      define SOKOL_ASSERT(c) assert(c)
+#    endif
+
+// The shared memory is accessed from other processes, so only lock-free atomics
+// on plain integers are used.
+#    define sgg__export_load_u64(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#    define sgg__export_store_u64(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#    define sgg__export_load_u32(ptr)         __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#    define sgg__export_store_u32(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#    define sgg__export_fence_acquire()       __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#    define sgg__export_fence_release()       __atomic_thread_fence(__ATOMIC_RELEASE)
+
+static bool sgg__map_export(sgg_export_consumer* consumer, uint64_t size) {
+  void* memory = mmap(NULL, (size_t)size, PROT_READ, MAP_SHARED, consumer->fd, 0);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  if (consumer->header) {
+    munmap((void*)consumer->header, (size_t)consumer->size);
+  }
+  consumer->header = (const sgg_export_header*)memory;
+  consumer->size   = size;
+  return true;
+}
+
+bool sgg_open_export(sgg_export_consumer* consumer, const char* name) {
+  SOKOL_ASSERT(consumer);
+  SOKOL_ASSERT(name);
+
+  *consumer = (sgg_export_consumer){.fd = shm_open(name, O_RDONLY, 0)};
+  if (consumer->fd < 0) {
+    return false;
+  }
+
+  // The producer writes the magic last, once the header is complete.
+  struct stat st;
+  if (fstat(consumer->fd, &st) != 0 || (uint64_t)st.st_size < sizeof(sgg_export_header) || !sgg__map_export(consumer, (uint64_t)st.st_size) ||
+      sgg__export_load_u32(&consumer->header->magic) != SGG_EXPORT_MAGIC || consumer->header->version != SGG_EXPORT_VERSION) {
+    sgg_close_export(consumer);
+    return false;
+  }
+
+  return true;
+}
+
+void sgg_close_export(sgg_export_consumer* consumer) {
+  SOKOL_ASSERT(consumer);
+
+  if (consumer->header) {
+    munmap((void*)consumer->header, (size_t)consumer->size);
+  }
+  if (consumer->fd >= 0) {
+    close(consumer->fd);
+  }
+  *consumer = (sgg_export_consumer){.fd = -1};
+}
+
+bool sgg_acquire_export_frame(sgg_export_consumer* consumer, sgg_export_frame* frame) {
+  SOKOL_ASSERT(consumer && consumer->header);
+  SOKOL_ASSERT(frame);
+
+  uint64_t frame_count = sgg__export_load_u64(&consumer->header->frame_count);
+  if (frame_count == consumer->frame_count) {
+    return false;
+  }
+
+  int                    index = (int)((frame_count - 1) % SGG_EXPORT_SLOT_COUNT);
+  const sgg_export_slot* slot  = &consumer->header->slots[index];
+
+  // Odd, if the producer has already lapped the consumer, the next call gets a
+  // newer frame.
+  uint64_t sequence = sgg__export_load_u64(&slot->sequence);
+  if (sequence & 1) {
+    return false;
+  }
+
+  sgg_export_slot copy = *slot;
+  sgg__export_fence_acquire();
+  if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) != sequence) {
+    return false;
+  }
+
+  // The slots of a grown shared memory are past the mapped part.
+  uint64_t end = copy.offset + (uint64_t)copy.stride * (uint64_t)copy.height;
+  if (end > consumer->size) {
+    uint64_t size = sgg__export_load_u64(&consumer->header->size);
+    if (end > size || !sgg__map_export(consumer, size)) {
+      return false;
+    }
+  }
+
+  *frame = (sgg_export_frame){
+    .pixels       = (const uint8_t*)consumer->header + copy.offset,
+    .width        = copy.width,
+    .height       = copy.height,
+    .stride       = copy.stride,
+    .format       = (sgg_export_format)copy.format,
+    .frame_id     = copy.frame_id,
+    .timestamp_ns = copy.timestamp_ns,
+    .skipped      = consumer->frame_count ? frame_count - consumer->frame_count - 1 : 0,
+  };
+
+  consumer->frame_count = frame_count;
+  consumer->sequence    = sequence;
+  consumer->slot        = index;
+  return true;
+}
+
+bool sgg_release_export_frame(sgg_export_consumer* consumer) {
+  SOKOL_ASSERT(consumer && consumer->header);
+  SOKOL_ASSERT(consumer->frame_count && "no frame was acquired");
+
+  sgg__export_fence_acquire();
+  return __atomic_load_n(&consumer->header->slots[consumer->slot].sequence, __ATOMIC_RELAXED) == consumer->sequence;
+}
+
+bool sgg_export_closed(const sgg_export_consumer* consumer) {
+  SOKOL_ASSERT(consumer && consumer->header);
+  return sgg__export_load_u32(&consumer->header->closed) != 0;
+}
+
+#  endif // SGG_EXPORT_IMPL_INCLUDED
+#endif   // SGG_EXPORT_CONSUMER_IMPL || SGG_ENABLE_EXPORT
+
+#if defined(SOKOL_GLFW_GLUE_IMPL) || defined(SOKOL_IMPL)
+
+#define SOKOL_GLFW_GLUE_IMPL_INCLUDED (1)
+
+// There's no Vulkan platform layer (surface, swapchain, acquire and present
+// semaphores) in the glue yet, also with a sokol_gfx that has a Vulkan backend.
+#if defined(SOKOL_VULKAN)
+#  error "SOKOL_VULKAN is not supported by sokol_glfw_glue.h"
+#endif
+
+#if !(defined(SOKOL_D3D11) || defined(SOKOL_METAL) || defined(SOKOL_GLCORE) || defined(SOKOL_DUMMY_BACKEND))
+#  error "Please select one of the supported backends: SOKOL_D3D11, SOKOL_METAL, SOKOL_GLCORE or SOKOL_DUMMY_BACKEND"
+#endif
+
+// Note: Relying on the headers that are being included from sokol_gfx.h.
+
+#ifdef SOKOL_DEBUG
+#  include <stdio.h> // printf
+#endif
+
+#if defined(SOKOL_D3D11)
+#  define GLFW_EXPOSE_NATIVE_WIN32
+#  include <d3d11_1.h> // DXGI*, ID3D11*, IDXGI*
+#  include <dxgi1_5.h> // DXGIGetDebugInterface1, IDXGIFactory5
+#  ifdef SOKOL_DEBUG
+#    include <dxgidebug.h> // ...
+#  endif
+#  ifdef _MSC_VER
+#    pragma comment(lib, "dxguid")
+#  endif
+#elif defined(SOKOL_METAL)
+#  if !__has_feature(objc_arc)
+#    error Objective-C's ARC is off. Use "-fobjc-arc" compiler flag to enable it.
+#  endif
+#  if !defined(SOKOL_GFX_IMPL_INCLUDED)
+#    error "With SOKOL_METAL, include the sokol_gfx implementation before the sokol_glfw_glue one, in the same file"
+#  endif
+#  define GLFW_EXPOSE_NATIVE_COCOA
+#  import <Cocoa/Cocoa.h> // NSWindow
+#endif
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>       // glfw*
+#include <GLFW/glfw3native.h> // glfwGet*Window
+
+#if defined(SOKOL_GLCORE)
+// From glfw3native.h, declared here so that the EGL headers aren't needed
+// (`EGLDisplay` and `EGLSurface` are pointers). Only called for windows whose
+// context was created with EGL.
+GLFWAPI void* glfwGetEGLDisplay(void);
+GLFWAPI void* glfwGetEGLSurface(GLFWwindow* window);
+
+#  if defined(_WIN32)
+#    define SGG__EGLAPIENTRY __stdcall
+#  else
+#    define SGG__EGLAPIENTRY
+#  endif
+
+#  define SGG__EGL_EXTENSIONS     0x3055
+#  define SGG__EGL_BUFFER_AGE_EXT 0x313D
+
+typedef const char*(SGG__EGLAPIENTRY* sgg__egl_string_func)(void* display, int32_t name);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_query_func)(void* display, void* surface, int32_t attribute, int32_t* value);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_damage_func)(void* display, void* surface, const int32_t* rects, int32_t rect_count);
+
+// The headless mode loads EGL itself, see `sgg__gl_init_headless`.
+#  if !defined(_WIN32)
+#    include <dlfcn.h> // dlopen, dlsym, dlclose
+#  endif
+
+#  define SGG__EGL_NONE                        0x3038
+#  define SGG__EGL_SURFACE_TYPE                0x3033
+#  define SGG__EGL_PBUFFER_BIT                 0x0001
+#  define SGG__EGL_RENDERABLE_TYPE             0x3040
+#  define SGG__EGL_OPENGL_BIT                  0x0008
+#  define SGG__EGL_OPENGL_API                  0x30A2
+#  define SGG__EGL_WIDTH                       0x3057
+#  define SGG__EGL_HEIGHT                      0x3056
+#  define SGG__EGL_CONTEXT_MAJOR_VERSION       0x3098
+#  define SGG__EGL_CONTEXT_MINOR_VERSION       0x30FB
+#  define SGG__EGL_CONTEXT_OPENGL_PROFILE_MASK 0x30FD
+#  define SGG__EGL_CONTEXT_OPENGL_CORE_PROFILE 0x0001
+#  define SGG__EGL_PLATFORM_DEVICE_EXT         0x313F
+#  define SGG__EGL_PLATFORM_SURFACELESS_MESA   0x31DD
+
+typedef void (*sgg__egl_proc)(void);
+typedef sgg__egl_proc(SGG__EGLAPIENTRY* sgg__egl_proc_func)(const char* name);
+typedef void*(SGG__EGLAPIENTRY* sgg__egl_display_func)(void* native_display);
+typedef void*(SGG__EGLAPIENTRY* sgg__egl_platform_func)(uint32_t platform, void* native_display, const int32_t* attributes);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_devices_func)(int32_t max_devices, void** devices, int32_t* device_count);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_init_func)(void* display, int32_t* major, int32_t* minor);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_config_func)(void* display, const int32_t* attributes, void** configs, int32_t config_size, int32_t* config_count);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_bind_func)(uint32_t api);
+typedef void*(SGG__EGLAPIENTRY* sgg__egl_context_func)(void* display, void* config, void* share_context, const int32_t* attributes);
+typedef void*(SGG__EGLAPIENTRY* sgg__egl_pbuffer_func)(void* display, void* config, const int32_t* attributes);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_current_func)(void* display, void* draw, void* read, void* context);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_destroy_func)(void* display, void* object);
+typedef unsigned int(SGG__EGLAPIENTRY* sgg__egl_terminate_func)(void* display);
+#endif // SOKOL_GLCORE
+
+#if defined(_WIN32)
+#  include <windows.h> // CreateWaitableTimerExW, SetWaitableTimer, Sleep
+#else
+#  include <sys/select.h> // select
+#endif
+
+#ifdef SGG_ENABLE_CAPTURE
+#  include <stdio.h> // FILE, fopen, fprintf, fwrite
+#  if defined(_WIN32)
+#    include <windows.h> // CONDITION_VARIABLE, CreateThread, CRITICAL_SECTION
+#  else
+#    include <pthread.h> // pthread_*
+#  endif
+#  if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#    define SGG__X86 (1)
+#    include <immintrin.h> // _mm_*, _mm256_*
+#    ifdef _MSC_VER
+#      include <intrin.h> // __cpuid, __cpuidex
+#    endif
+#  elif defined(__ARM_NEON) || defined(_M_ARM64)
+#    define SGG__NEON (1)
+#    include <arm_neon.h> // v*
+#  endif
+#endif // SGG_ENABLE_CAPTURE
+
+#ifdef SGG_ENABLE_TRACE
+#  include <stdio.h> // FILE, fopen, fprintf, fputc
+#  ifdef _MSC_VER
+#    define SGG__THREAD_LOCAL __declspec(thread)
+#  else
+#    define SGG__THREAD_LOCAL __thread
+#  endif
+#endif // SGG_ENABLE_TRACE
+
+#define SGG__MAX_FRAMES_IN_FLIGHT 3
+
+// The adaptive render scale is `steps / SGG__SCALE_STEPS`.
+#define SGG__SCALE_STEPS            20
+#define SGG__SCALE_COOLDOWN_FRAMES  30
+#define SGG__SCALE_PROBE_FRAMES     120
+#define SGG__SCALE_MAX_PROBE_FRAMES 3840
+
+// Number of present timestamps the vblank phase is estimated from, and the age
+// after which they're ignored.
+#define SGG__VBLANK_SAMPLES     16
+#define SGG__VBLANK_MAX_AGE_MS  500.0
+#define SGG__MAX_SLEEP_SLACK_MS 50.0
+
+// Number of frames whose damage is kept, i.e., the oldest back buffer the
+// accumulated damage can be computed for.
+#define SGG__DAMAGE_HISTORY 4
+
+#define SGG__DEFAULT_RING_ALIGNMENT 256
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h> // _Interlocked*
+typedef volatile long    sgg__atomic_u32;
+typedef volatile __int64 sgg__atomic_u64;
+#  define sgg__atomic_load_u32(ptr)            ((uint32_t)_InterlockedOr((ptr), 0))
+#  define sgg__atomic_store_u32(ptr, value)    ((void)_InterlockedExchange((ptr), (long)(value)))
+#  define sgg__atomic_exchange_u64(ptr, value) ((uint64_t)_InterlockedExchange64((ptr), (__int64)(value)))
+#  define sgg__atomic_add_u32(ptr, value)      ((uint32_t)_InterlockedExchangeAdd((ptr), (long)(value)))
+#  define sgg__atomic_fence()                  MemoryBarrier()
+#else
+typedef uint32_t sgg__atomic_u32;
+typedef uint64_t sgg__atomic_u64;
+#  define sgg__atomic_load_u32(ptr)            __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#  define sgg__atomic_store_u32(ptr, value)    __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#  define sgg__atomic_exchange_u64(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#  define sgg__atomic_add_u32(ptr, value)      __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#  define sgg__atomic_fence()                  __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+// Damage of a presented frame, in swapchain pixels of the given size. No
+// rectangles means the whole frame.
+typedef struct {
+  sgg_size size;
+  sgg_rect rects[SGG_MAX_DAMAGE_RECTS];
+  int      count;
+} sgg__damage;
+
+typedef enum {
+  SGG__EVENT_FRAMEBUFFER_SIZE,
+  SGG__EVENT_CONTENT_SCALE,
+  SGG__EVENT_MONITOR_SIZE,
+} sgg__event_type;
+
+typedef struct {
+  sgg__event_type type;
+  int             width;
+  int             height;
+  float           x_scale;
+  float           y_scale;
+} sgg__event;
+
+// Single-producer (main thread), single-consumer (render thread) queue. If it's
+// full, the producer stores the latest event of each type in an overflow slot
+// instead (only the latest size / scale matters), with the top bit set to mark
+// it as valid.
+typedef struct {
+  sgg__event      events[SGG_EVENT_QUEUE_SIZE];
+  sgg__atomic_u32 head;
+  sgg__atomic_u32 tail;
+  sgg__atomic_u64 overflow_size;
+  sgg__atomic_u64 overflow_scale;
+  sgg__atomic_u64 overflow_monitor_size;
+} sgg__event_queue;
+
+#ifdef SGG_ENABLE_FRAME_STATS
+typedef struct {
+  double   samples[SGG_FRAME_STATS_HISTORY];
+  uint32_t count;
+  uint32_t next;
+} sgg__timing_ring;
+
+typedef struct {
+  sgg__timing_ring acquire;
+  sgg__timing_ring present;
+  sgg__timing_ring resize;
+} sgg__frame_stats;
+#endif // SGG_ENABLE_FRAME_STATS
+
+#ifdef SGG_ENABLE_TRACE
+typedef struct {
+  uint64_t    ticks;
+  const char* name; // `NULL` ends the innermost span.
+} sgg__trace_event;
+
+// Ring written only by the owning thread. An event is stored first, and then
+// published by bumping `count`.
+typedef struct {
+  sgg__trace_event events[SGG_TRACE_EVENT_COUNT];
+  uint32_t         next;
+  sgg__atomic_u32  count;
+} sgg__trace_buffer;
+
+typedef struct {
+  sgg__trace_buffer buffers[SGG_TRACE_MAX_THREADS];
+  sgg__atomic_u32   thread_count;
+} sgg__trace;
+#endif // SGG_ENABLE_TRACE
+
+#ifdef SGG_ENABLE_CAPTURE
+#  if defined(_WIN32)
+typedef HANDLE             sgg__thread;
+typedef CRITICAL_SECTION   sgg__mutex;
+typedef CONDITION_VARIABLE sgg__cond;
+#  else
+typedef pthread_t       sgg__thread;
+typedef pthread_mutex_t sgg__mutex;
+typedef pthread_cond_t  sgg__cond;
+#  endif
+
+typedef void (*sgg__row_func)(const uint8_t* src, uint8_t* dst, int width);
+typedef void (*sgg__uv_row_func)(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width);
+
+typedef struct {
+  sgg__row_func    rgba_row;
+  sgg__row_func    y_row;
+  sgg__uv_row_func uv_row;
+} sgg__pixel_kernels;
+
+typedef struct {
+  sgg_readback source;
+  bool         skip;
+  uint8_t*     data;
+} sgg__capture_slot;
+
+// The slots go through three stages, in order: filled with a mapped readback by
+// the presenting thread (up to `head`), converted by the converter thread (up to
+// `converted`), and written by the writer thread (up to `tail`). The readbacks
+// are unmapped by the presenting thread once converted (up to `released`).
+typedef struct {
+  bool               active;
+  uint32_t           context_id;
+  sgg_capture_desc   desc;
+  sgg__pixel_kernels kernels;
+  FILE*              file;
+  int                width;
+  int                height;
+  uint64_t           frame_size;
+  sgg__capture_slot* slots;
+  uint32_t           head;
+  uint32_t           converted;
+  uint32_t           tail;
+  uint32_t           released;
+  bool               stop;
+  sgg_capture_stats  stats;
+  sgg__mutex         mutex;
+  sgg__cond          convert_cond;
+  sgg__cond          write_cond;
+  sgg__thread        converter_thread;
+  sgg__thread        writer_thread;
+} sgg__capture;
+#endif // SGG_ENABLE_CAPTURE
+
+#ifdef SGG_ENABLE_EXPORT
+// The slots are `slot_capacity` bytes each, from `data_offset` on. Growing puts
+// them past the end of the previous ones, so that the consumers still reading
+// the old ones never see them reused for another slot.
+typedef struct {
+  bool               active;
+  uint32_t           context_id;
+  sgg_export_desc    desc;
+  int                fd;
+  sgg_export_header* header;
+  uint64_t           data_offset;
+  uint64_t           slot_capacity;
+  sgg_export_stats   stats;
+} sgg__export;
+#endif // SGG_ENABLE_EXPORT
+
+typedef struct {
+  int      steps;
+  int      min_steps;
+  int      max_steps;
+  double   target_ms;
+  double   hysteresis;
+  double   average_ms;
+  int      cooldown_frames;
+  int      stable_frames;
+  int      probe_frames;
+  bool     probing;
+  bool     reported;
+  uint64_t last_present_ticks;
+} sgg__scale_controller;
+
+typedef struct {
+  double   vblank_samples[SGG__VBLANK_SAMPLES];
+  int      vblank_sample_count;
+  int      next_vblank_sample;
+  double   vblank_ms;
+  bool     has_vblank;
+  double   frame_start_ms;
+  bool     has_frame_start;
+  double   last_present_ms;
+  bool     has_last_present;
+  bool     vblank_reported;
+  double   cost_ms;
+  double   cost_deviation_ms;
+  bool     has_cost;
+} sgg__frame_pacer;
+
+// clang-format off
+typedef struct {
+  int                       width;
+  int                       height;
+  uint64_t                  frame_index;
+#if defined(SOKOL_D3D11)
+  ID3D11Texture2D*          texture;
+  int                       texture_width;
+  int                       texture_height;
+#elif defined(SOKOL_METAL)
+  id<MTLBuffer>             buffer;
+  id<MTLCommandBuffer>      command_buffer;
+#elif defined(SOKOL_GLCORE)
+  GLuint                    buffer;
+  GLsizeiptr                buffer_size;
+  GLsync                    fence;
+#elif defined(SOKOL_DUMMY_BACKEND)
+  void*                     pixels;
+  size_t                    pixels_size;
+#endif // SOKOL_* backend
+} sgg__readback;
+
+typedef struct {
+  uint32_t                  id;
+  sgg_environment_desc      desc;
+  sgg_present_mode          present_mode;
+  bool                      dirty;
+  bool                      size_dirty;
+  int                       framebuffer_width;
+  int                       framebuffer_height;
+  float                     content_scale_x;
+  float                     content_scale_y;
+  sgg_size                  monitor_size;
+  sgg_size                  planned_monitor_size;
+  sgg_size                  backbuffer_size;
+  sgg_size                  swapchain_size;
+  sgg__damage               damage[SGG__DAMAGE_HISTORY];
+  sgg__scale_controller     scale;
+  sgg__frame_pacer          pacer;
+  GLFWframebuffersizefun    prev_framebuffer_size_callback;
+  GLFWwindowcontentscalefun prev_content_scale_callback;
+  GLFWwindowrefreshfun      prev_refresh_callback;
+  GLFWwindowiconifyfun      prev_iconify_callback;
+  GLFWwindowposfun          prev_pos_callback;
+  GLFWwindowfocusfun        prev_focus_callback;
+  GLFWkeyfun                prev_key_callback;
+  GLFWcharfun               prev_char_callback;
+  GLFWmousebuttonfun        prev_mouse_button_callback;
+  GLFWcursorposfun          prev_cursor_pos_callback;
+  GLFWcursorenterfun        prev_cursor_enter_callback;
+  GLFWscrollfun             prev_scroll_callback;
+  GLFWdropfun               prev_drop_callback;
+  sgg__event_queue          events;
+  sgg__atomic_u32           invalidated;
+  sgg__atomic_u32           iconified;
+  sgg__atomic_u32           occluded;
+  sgg__atomic_u32           refresh_rate;
+  uint64_t                  resize_count;
+  uint64_t                  present_count;
+  uint64_t                  backbuffer_bytes;
+  int                       shrink_pending_frames;
+  double                    shrink_pending_since;
+  uint64_t                  frame_index;
+  uint64_t                  waited_frame_index;
+  sgg_window_event*         recorded_events;
+  int                       recorded_capacity;
+  int                       recorded_count;
+  double                    recording_start;
+  sgg__readback*            readbacks;
+  uint32_t                  readback_count;
+  uint32_t                  readback_head;
+  uint32_t                  readback_tail;
+  uint32_t                  readback_mapped;
+  bool                      readback_requested;
+#ifdef SGG_ENABLE_FRAME_STATS
+  sgg__frame_stats          stats;
+#endif
+#if defined(SOKOL_D3D11)
+  IDXGISwapChain1*          swapchain;
+  DXGI_SWAP_CHAIN_DESC1     swapchain_desc;
+  ID3D11RenderTargetView*   render_target_view;
+  ID3D11Texture2D*          msaa_texture;
+  ID3D11RenderTargetView*   msaa_view;
+  ID3D11Texture2D*          depth_stencil_texture;
+  ID3D11DepthStencilView*   depth_stencil_view;
+  HANDLE                    frame_latency_waitable;
+  sgg_size                  source_size;
+#elif defined(SOKOL_METAL)
+  CAMetalLayer*             layer;
+  id<CAMetalDrawable>       drawable;
+  dispatch_semaphore_t      frame_semaphore;
+  bool                      frame_slot_acquired;
+  id<MTLTexture>            msaa_texture;
+  id<MTLTexture>            depth_stencil_texture;
+  id                        occlusion_observer;
+  sgg__atomic_u64           presented_time_ns;
+#elif defined(SOKOL_GLCORE)
+  int                       swap_interval;
+  GLuint                    color_renderbuffer;
+  GLuint                    depth_stencil_renderbuffer;
+  GLuint                    framebuffer;
+  GLuint                    blit_framebuffer;
+  GLuint                    blit_renderbuffer;
+  bool                      blit_framebuffer_stale;
+  GLsync                    frame_fences[SGG__MAX_FRAMES_IN_FLIGHT];
+  int                       frame_fence_index;
+  GLuint                    resolve_framebuffer;
+  GLuint                    resolve_renderbuffer;
+  sgg_size                  resolve_size;
+  void*                     egl_surface;
+#elif defined(SOKOL_DUMMY_BACKEND)
+  int                       width;
+  int                       height;
+#endif // SOKOL_* backend
+} sgg__context;
+
+typedef struct {
+  uint32_t                  context_id;
+  sg_buffer                 buffers[SGG__MAX_FRAMES_IN_FLIGHT];
+  int                       buffer_count;
+  int                       size;
+  int                       alignment;
+  uint8_t*                  staging;
+  int                       used;
+  bool                      flushed;
+  uint64_t                  frame_index;
+} sgg__ring;
+
+typedef struct {
+  bool                      valid;
+  bool                      render_thread;
+  uint32_t                  current_context_id;
+  double                    timer_period_ms;
+  sgg_clock_func            clock_func;
+  void*                     clock_user_data;
+  double                    sleep_slack_ms;
+  bool                      device_started;
+  GLFWmonitorfun            prev_monitor_callback;
+  sgg__context              contexts[SGG_MAX_CONTEXTS];
+  sgg__ring                 rings[SGG_MAX_RINGS];
+#ifdef SGG_ENABLE_CAPTURE
+  sgg__capture              capture;
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  sgg__export               frame_export;
+#endif
+#if defined(SOKOL_D3D11)
+  ID3D11Device*             base_device;
+  ID3D11DeviceContext*      base_device_context;
+  ID3D11Device1*            device;
+  ID3D11DeviceContext1*     device_context;
+  IDXGIFactory2*            factory;
+  bool                      allow_tearing;
+  HANDLE                    device_thread;
+#elif defined(SOKOL_METAL)
+  id<MTLDevice>             device;
+  dispatch_group_t          device_group;
+#elif defined(SOKOL_GLCORE)
+  GLFWwindow*               main_window;
+  bool                      swap_control_tear;
+  void*                     egl_display;
+  sgg__egl_query_func       egl_query_surface;
+  sgg__egl_damage_func      egl_swap_buffers_with_damage;
+  void*                     egl_library;
+  void*                     headless_display;
+  void*                     headless_surface;
+  void*                     headless_context;
+  sgg__egl_current_func     egl_make_current;
+#endif // SOKOL_* backend
+} sgg__state;
+// clang-format on
+
+static sgg__state g_sgg_state = {0};
+
+// Kept apart from `g_sgg_state`, so that the context handles of a previous
+// initialization stay invalid after `sgg_shutdown`.
+static uint32_t g_sgg_context_generations[SGG_MAX_CONTEXTS] = {0};
+
+#ifdef SGG_ENABLE_TRACE
+// Kept apart from `g_sgg_state`, so that the events survive `sgg_shutdown`,
+// and the threads' buffers stay claimed.
+static sgg__trace g_sgg_trace = {0};
+
+static SGG__THREAD_LOCAL sgg__trace_buffer* g_sgg_trace_buffer = NULL;
+#endif
+
+static int sgg__sample_count(const sgg_environment_desc* desc) {
+  return desc->sample_count > 1 ? desc->sample_count : 1;
+}
+
+static int sgg__swapchain_buffer_count(const sgg_environment_desc* desc) {
+  return desc->swapchain_buffer_count ? desc->swapchain_buffer_count : 2;
+}
+
+static int sgg__max_frames_in_flight(const sgg_environment_desc* desc) {
+  return desc->max_frames_in_flight ? desc->max_frames_in_flight : 2;
+}
+
+static uint64_t sgg__backbuffer_bytes(const sgg_environment_desc* desc, int width, int height) {
+  uint64_t pixels       = (uint64_t)width * (uint64_t)height;
+  uint64_t sample_count = (uint64_t)sgg__sample_count(desc);
+  uint64_t buffer_count = (uint64_t)sgg__swapchain_buffer_count(desc);
+  uint64_t bytes        = pixels * 4 * buffer_count;
+
+  if (sample_count > 1) {
+    bytes += pixels * 4 * sample_count;
+  }
+  if (desc->depth_format != SGG_DEPTH_FORMAT_NONE) {
+    bytes += pixels * 4 * sample_count;
+  }
+
+  return bytes;
+}
+
+static sg_pixel_format sgg__depth_pixel_format(const sgg_environment_desc* desc) {
+  switch (desc->depth_format) {
+  case SGG_DEPTH_FORMAT_DEPTH:
+    return SG_PIXELFORMAT_DEPTH;
+  case SGG_DEPTH_FORMAT_DEPTH_STENCIL:
+    return SG_PIXELFORMAT_DEPTH_STENCIL;
+  default:
+    return SG_PIXELFORMAT_NONE;
+  }
+}
+
+static int sgg__min(int a, int b) {
+  return a < b ? a : b;
+}
+
+static int sgg__max(int a, int b) {
+  return a > b ? a : b;
+}
+
+// Damage of the frame being presented, or `NULL` if it's the whole frame.
+static const sgg__damage* sgg__current_damage(const sgg__context* ctx) {
+  const sgg__damage* damage = &ctx->damage[ctx->frame_index % SGG__DAMAGE_HISTORY];
+  return damage->count > 0 ? damage : NULL;
+}
+
+static sgg_rect sgg__union_rect(sgg_rect a, sgg_rect b) {
+  int left   = sgg__min(a.x, b.x);
+  int top    = sgg__min(a.y, b.y);
+  int right  = sgg__max(a.x + a.width, b.x + b.width);
+  int bottom = sgg__max(a.y + a.height, b.y + b.height);
+  return (sgg_rect){left, top, right - left, bottom - top};
+}
+
+static void sgg__add_damage_rect(sgg__damage* damage, sgg_rect rect) {
+  if (damage->count < SGG_MAX_DAMAGE_RECTS) {
+    damage->rects[damage->count++] = rect;
+    return;
+  }
+
+  // Out of space, everything is merged into the bounding box.
+  for (int i = 0; i < damage->count; i++) {
+    rect = sgg__union_rect(rect, damage->rects[i]);
+  }
+  damage->rects[0] = rect;
+  damage->count    = 1;
+}
+
+// Damage accumulated over the last `age` frames, including the one being
+// presented, i.e., what changed in a back buffer last drawn to `age` frames
+// ago. Returns `false` if it's the whole frame.
+static bool sgg__accumulate_damage(const sgg__context* ctx, int age, sgg__damage* result) {
+  if (age < 1 || age > SGG__DAMAGE_HISTORY || (uint64_t)age > ctx->frame_index + 1) {
+    return false;
+  }
+
+  *result = (sgg__damage){.size = ctx->swapchain_size};
+  for (int i = 0; i < age; i++) {
+    const sgg__damage* damage = &ctx->damage[(ctx->frame_index - (uint64_t)i) % SGG__DAMAGE_HISTORY];
+    if (damage->count == 0 || damage->size.width != result->size.width || damage->size.height != result->size.height) {
+      return false;
+    }
+    for (int j = 0; j < damage->count; j++) {
+      sgg__add_damage_rect(result, damage->rects[j]);
+    }
+  }
+  return true;
+}
+
+#if defined(SOKOL_D3D11)
+// `sokol_gfx.h` doesn't define COBJMACROS before including D3D11 and DXGI
+// headers, and now it's too late.
+#  if !defined(__cplusplus) && !defined(COBJMACROS)
+#    define ID3D11DepthStencilView_Release(This)                                                                              ((This)->lpVtbl->Release(This))
+#    define ID3D11Device1_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
+#    define ID3D11Device_CreateDepthStencilView(This, pResource, pDesc, ppDepthStencilView)                                   ((This)->lpVtbl->CreateDepthStencilView(This, pResource, pDesc, ppDepthStencilView))
+#    define ID3D11Device_CreateRenderTargetView(This, pResource, pDesc, ppRTView)                                             ((This)->lpVtbl->CreateRenderTargetView(This, pResource, pDesc, ppRTView))
+#    define ID3D11Device_CreateTexture2D(This, pDesc, pInitialData, ppTexture2D)                                              ((This)->lpVtbl->CreateTexture2D(This, pDesc, pInitialData, ppTexture2D))
+#    define ID3D11Device_QueryInterface(This, riid, ppvObject)                                                                ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
+#    define ID3D11Device_Release(This)                                                                                        ((This)->lpVtbl->Release(This))
+#    define ID3D11DeviceContext1_QueryInterface(This, riid, ppvObject)                                                        ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
+#    define ID3D11DeviceContext1_Release(This)                                                                                ((This)->lpVtbl->Release(This))
+#    define ID3D11DeviceContext_CopySubresourceRegion(This, pDstResource, DstSubresource, DstX, DstY, DstZ, pSrcResource, SrcSubresource, pSrcBox) ((This)->lpVtbl->CopySubresourceRegion(This, pDstResource, DstSubresource, DstX, DstY, DstZ, pSrcResource, SrcSubresource, pSrcBox))
+#    define ID3D11DeviceContext_Map(This, pResource, Subresource, MapType, MapFlags, pMappedResource)                         ((This)->lpVtbl->Map(This, pResource, Subresource, MapType, MapFlags, pMappedResource))
+#    define ID3D11DeviceContext_QueryInterface(This, riid, ppvObject)                                                         ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
+#    define ID3D11DeviceContext_Release(This)                                                                                 ((This)->lpVtbl->Release(This))
+#    define ID3D11DeviceContext_Unmap(This, pResource, Subresource)                                                           ((This)->lpVtbl->Unmap(This, pResource, Subresource))
+#    define ID3D11RenderTargetView_Release(This)                                                                              ((This)->lpVtbl->Release(This))
+#    define ID3D11Texture2D_Release(This)                                                                                     ((This)->lpVtbl->Release(This))
+#    define IDXGIAdapter1_GetParent(This, riid, ppParent)                                                                     ((This)->lpVtbl->GetParent(This, riid, ppParent))
+#    define IDXGIAdapter1_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
+#    define IDXGIDevice1_Release(This)                                                                                        ((This)->lpVtbl->Release(This))
+#    define IDXGIDevice_GetParent(This, riid, ppParent)                                                                       ((This)->lpVtbl->GetParent(This, riid, ppParent))
+#    define IDXGIFactory2_CreateSwapChainForHwnd(This, pDevice, hWnd, pDesc, pFullscreenDesc, pRestrictToOutput, ppSwapChain) ((This)->lpVtbl->CreateSwapChainForHwnd(This, pDevice, hWnd, pDesc, pFullscreenDesc, pRestrictToOutput, ppSwapChain))
+#    define IDXGIFactory2_QueryInterface(This, riid, ppvObject)                                                               ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
+#    define IDXGIFactory2_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
+#    define IDXGIFactory5_CheckFeatureSupport(This, Feature, pFeatureSupportData, FeatureSupportDataSize)                     ((This)->lpVtbl->CheckFeatureSupport(This, Feature, pFeatureSupportData, FeatureSupportDataSize))
+#    define IDXGIFactory5_Release(This)                                                                                       ((This)->lpVtbl->Release(This))
+#    define IDXGISwapChain1_GetBackgroundColor(This, pColor)                                                                  ((This)->lpVtbl->GetBackgroundColor(This, pColor))
+#    define IDXGISwapChain1_GetBuffer(This, Buffer, riid, ppSurface)                                                          ((This)->lpVtbl->GetBuffer(This, Buffer, riid, ppSurface))
+#    define IDXGISwapChain1_GetFrameStatistics(This, pStats)                                                                  ((This)->lpVtbl->GetFrameStatistics(This, pStats))
+#    define IDXGISwapChain1_Present1(This, SyncInterval, PresentFlags, pPresentParameters)                                    ((This)->lpVtbl->Present1(This, SyncInterval, PresentFlags, pPresentParameters))
+#    define IDXGISwapChain1_Present(This, SyncInterval, Flags)                                                                ((This)->lpVtbl->Present(This, SyncInterval, Flags))
+#    define IDXGISwapChain1_QueryInterface(This, riid, ppvObject)                                                             ((This)->lpVtbl->QueryInterface(This, riid, ppvObject))
+#    define IDXGISwapChain1_Release(This)                                                                                     ((This)->lpVtbl->Release(This))
+#    define IDXGISwapChain1_ResizeBuffers(This, BufferCount, Width, Height, NewFormat, SwapChainFlags)                        ((This)->lpVtbl->ResizeBuffers(This, BufferCount, Width, Height, NewFormat, SwapChainFlags))
+#    define IDXGISwapChain2_GetFrameLatencyWaitableObject(This)                                                               ((This)->lpVtbl->GetFrameLatencyWaitableObject(This))
+#    define IDXGISwapChain2_Release(This)                                                                                     ((This)->lpVtbl->Release(This))
+#    define IDXGISwapChain2_SetMaximumFrameLatency(This, MaxLatency)                                                          ((This)->lpVtbl->SetMaximumFrameLatency(This, MaxLatency))
+#    define IDXGISwapChain2_SetSourceSize(This, Width, Height)                                                                ((This)->lpVtbl->SetSourceSize(This, Width, Height))
+#  endif // !__cplusplus && !COBJMACROS
+
+static void sgg__platform_init_device(sgg__state* state) {
+  D3D_FEATURE_LEVEL    feature_levels[] = {D3D_FEATURE_LEVEL_11_1};
+  ID3D11Device*        base_device;
+  ID3D11DeviceContext* base_device_context;
+
+  UINT device_flags = 0;
+  device_flags |= D3D11_CREATE_DEVICE_SINGLETHREADED; // TODO : Runtime configurable ?
+  device_flags |= D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+#  ifdef SOKOL_DEBUG
+  device_flags |= D3D11_CREATE_DEVICE_DEBUG; // TODO : Runtime configurable ?
+#  endif
+
+  HRESULT hr = D3D11CreateDevice(
+    NULL,
+    D3D_DRIVER_TYPE_HARDWARE,
+    NULL,
+    device_flags,
+    feature_levels,
+    1,
+    D3D11_SDK_VERSION,
+    &base_device,
+    NULL,
+    &base_device_context);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  ID3D11Device1* device;
+  hr = ID3D11Device_QueryInterface(base_device, &IID_ID3D11Device1, (void**)(&device));
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  ID3D11DeviceContext1* device_context;
+  hr = ID3D11DeviceContext_QueryInterface(base_device_context, &IID_ID3D11DeviceContext1, (void**)&device_context);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  IDXGIDevice1* dxgi_device;
+  hr = ID3D11Device_QueryInterface(device, &IID_IDXGIDevice1, (void**)&dxgi_device);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  IDXGIAdapter1* adapter;
+  hr = IDXGIDevice_GetParent(dxgi_device, &IID_IDXGIAdapter1, (void**)&adapter);
+  SOKOL_ASSERT(SUCCEEDED(hr));
 
   IDXGIFactory2* factory;
   hr = IDXGIAdapter1_GetParent(adapter, &IID_IDXGIFactory2, (void**)&factory);
   SOKOL_ASSERT(SUCCEEDED(hr));
 
-  DXGI_SWAP_CHAIN_DESC1 swapchain_desc = {
-    .Format           = DXGI_FORMAT_B8G8R8A8_UNORM,
-    .SampleDesc.Count = 1,
-    .BufferUsage      = DXGI_USAGE_RENDER_TARGET_OUTPUT,
-    .BufferCount      = 2,
-    .Scaling          = DXGI_SCALING_NONE,
-    .Flags            = 0,
-    .SwapEffect       = DXGI_SWAP_EFFECT_FLIP_DISCARD,
+  IDXGIAdapter1_Release(adapter);
+  IDXGIDevice1_Release(dxgi_device);
+
+  // Tearing needs Windows 10 and a driver (and display) supporting it.
+  BOOL           allow_tearing = FALSE;
+  IDXGIFactory5* factory5;
+  if (SUCCEEDED(IDXGIFactory2_QueryInterface(factory, &IID_IDXGIFactory5, (void**)&factory5))) {
+    if (FAILED(IDXGIFactory5_CheckFeatureSupport(factory5, DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow_tearing, sizeof(allow_tearing)))) {
+      allow_tearing = FALSE;
+    }
+    IDXGIFactory5_Release(factory5);
+  }
+
+  state->base_device         = base_device;
+  state->base_device_context = base_device_context;
+  state->device              = device;
+  state->device_context      = device_context;
+  state->factory             = factory;
+  state->allow_tearing       = allow_tearing != FALSE;
+}
+
+static DWORD WINAPI sgg__d3d11_init_device_proc(LPVOID param) {
+  sgg__platform_init_device((sgg__state*)param);
+  return 0;
+}
+
+static void sgg__platform_begin_init_device(sgg__state* state) {
+  state->device_thread = CreateThread(NULL, 0, sgg__d3d11_init_device_proc, state, 0, NULL);
+  if (!state->device_thread) {
+    sgg__platform_init_device(state);
+  }
+}
+
+static void sgg__platform_wait_device(sgg__state* state) {
+  if (state->device_thread) {
+    WaitForSingleObject(state->device_thread, INFINITE);
+    CloseHandle(state->device_thread);
+    state->device_thread = NULL;
+  }
+}
+
+static bool sgg__platform_init(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+  return true;
+}
+
+static sgg_present_mode sgg__platform_present_mode(const sgg__state* state, sgg_present_mode mode) {
+  switch (mode) {
+  case SGG_PRESENT_MODE_FIFO_RELAXED:
+    return SGG_PRESENT_MODE_FIFO;
+  case SGG_PRESENT_MODE_IMMEDIATE:
+    return state->allow_tearing ? SGG_PRESENT_MODE_IMMEDIATE : SGG_PRESENT_MODE_MAILBOX;
+  default:
+    return mode;
+  }
+}
+
+static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
+  env->d3d11.device         = state->base_device;
+  env->d3d11.device_context = state->base_device_context;
+}
+
+static void sgg__platform_render_thread_begin(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_render_thread_end(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_init_context(sgg__state* state, sgg__context* ctx) {
+  DXGI_SWAP_CHAIN_DESC1 swapchain_desc = {
+    .Format           = DXGI_FORMAT_B8G8R8A8_UNORM,
+    .SampleDesc.Count = 1,
+    .BufferUsage      = DXGI_USAGE_RENDER_TARGET_OUTPUT,
+    .BufferCount      = (UINT)sgg__swapchain_buffer_count(&ctx->desc),
+    .Scaling          = ctx->desc.adaptive_resolution ? DXGI_SCALING_STRETCH : DXGI_SCALING_NONE,
+    .Flags            = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT,
+    .SwapEffect       = ctx->desc.partial_present ? DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL : DXGI_SWAP_EFFECT_FLIP_DISCARD,
+  };
+
+  // Set whenever supported, so that the present mode can be switched without
+  // recreating the swapchain.
+  if (state->allow_tearing) {
+    swapchain_desc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+  }
+
+  IDXGISwapChain1* swapchain;
+  HRESULT          hr = IDXGIFactory2_CreateSwapChainForHwnd(
+    state->factory,
+    (IUnknown*)state->device,
+    glfwGetWin32Window(ctx->desc.window),
+    &swapchain_desc,
+    NULL,
+    NULL,
+    &swapchain);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  IDXGISwapChain2* swapchain2;
+  hr = IDXGISwapChain1_QueryInterface(swapchain, &IID_IDXGISwapChain2, (void**)&swapchain2);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  hr = IDXGISwapChain2_SetMaximumFrameLatency(swapchain2, (UINT)sgg__max_frames_in_flight(&ctx->desc));
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  ctx->frame_latency_waitable = IDXGISwapChain2_GetFrameLatencyWaitableObject(swapchain2);
+  SOKOL_ASSERT(ctx->frame_latency_waitable);
+
+  IDXGISwapChain2_Release(swapchain2);
+
+  ctx->swapchain      = swapchain;
+  ctx->swapchain_desc = swapchain_desc;
+}
+
+static void sgg__d3d11_release_attachments(sgg__context* ctx) {
+  if (ctx->render_target_view) {
+    ID3D11RenderTargetView_Release(ctx->render_target_view);
+    ctx->render_target_view = NULL;
+  }
+  if (ctx->msaa_view) {
+    ID3D11RenderTargetView_Release(ctx->msaa_view);
+    ctx->msaa_view = NULL;
+  }
+  if (ctx->msaa_texture) {
+    ID3D11Texture2D_Release(ctx->msaa_texture);
+    ctx->msaa_texture = NULL;
+  }
+  if (ctx->depth_stencil_view) {
+    ID3D11DepthStencilView_Release(ctx->depth_stencil_view);
+    ctx->depth_stencil_view = NULL;
+  }
+  if (ctx->depth_stencil_texture) {
+    ID3D11Texture2D_Release(ctx->depth_stencil_texture);
+    ctx->depth_stencil_texture = NULL;
+  }
+}
+
+static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, sgg__context* ctx, int width, int height) {
+  sgg__d3d11_release_attachments(ctx);
+
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  ctx->swapchain_desc.Width  = (UINT)width;
+  ctx->swapchain_desc.Height = (UINT)height;
+  ctx->source_size           = (sgg_size){width, height};
+
+  HRESULT hr = IDXGISwapChain1_ResizeBuffers(ctx->swapchain, 0, (UINT)width, (UINT)height, DXGI_FORMAT_B8G8R8A8_UNORM, ctx->swapchain_desc.Flags);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  ID3D11Texture2D* backbuffer;
+  hr = IDXGISwapChain1_GetBuffer(ctx->swapchain, 0, &IID_ID3D11Texture2D, (void**)&backbuffer);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  hr = ID3D11Device_CreateRenderTargetView(state->device, (ID3D11Resource*)backbuffer, NULL, &ctx->render_target_view);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  ID3D11Texture2D_Release(backbuffer);
+
+  UINT sample_count = (UINT)sgg__sample_count(&ctx->desc);
+
+  if (sample_count > 1) {
+    D3D11_TEXTURE2D_DESC msaa_desc = {
+      .Width            = (UINT)width,
+      .Height           = (UINT)height,
+      .MipLevels        = 1,
+      .ArraySize        = 1,
+      .Format           = DXGI_FORMAT_B8G8R8A8_UNORM,
+      .SampleDesc.Count = sample_count,
+      .Usage            = D3D11_USAGE_DEFAULT,
+      .BindFlags        = D3D11_BIND_RENDER_TARGET,
+    };
+    hr = ID3D11Device_CreateTexture2D(state->device, &msaa_desc, NULL, &ctx->msaa_texture);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+
+    hr = ID3D11Device_CreateRenderTargetView(state->device, (ID3D11Resource*)ctx->msaa_texture, NULL, &ctx->msaa_view);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+  }
+
+  if (ctx->desc.depth_format != SGG_DEPTH_FORMAT_NONE) {
+    D3D11_TEXTURE2D_DESC depth_desc = {
+      .Width            = (UINT)width,
+      .Height           = (UINT)height,
+      .MipLevels        = 1,
+      .ArraySize        = 1,
+      .Format           = ctx->desc.depth_format == SGG_DEPTH_FORMAT_DEPTH ? DXGI_FORMAT_D32_FLOAT : DXGI_FORMAT_D24_UNORM_S8_UINT,
+      .SampleDesc.Count = sample_count,
+      .Usage            = D3D11_USAGE_DEFAULT,
+      .BindFlags        = D3D11_BIND_DEPTH_STENCIL,
+    };
+    hr = ID3D11Device_CreateTexture2D(state->device, &depth_desc, NULL, &ctx->depth_stencil_texture);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+
+    hr = ID3D11Device_CreateDepthStencilView(state->device, (ID3D11Resource*)ctx->depth_stencil_texture, NULL, &ctx->depth_stencil_view);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+  }
+}
+
+static void sgg__platform_swapchain(sgg__state* state, sgg__context* ctx, sg_swapchain* swapchain) {
+  _SOKOL_UNUSED(state);
+
+  // Only the source region (top-left) is stretched over the window.
+  if (ctx->desc.adaptive_resolution && swapchain->width && (ctx->source_size.width != swapchain->width || ctx->source_size.height != swapchain->height)) {
+    IDXGISwapChain2* swapchain2;
+    HRESULT          hr = IDXGISwapChain1_QueryInterface(ctx->swapchain, &IID_IDXGISwapChain2, (void**)&swapchain2);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+
+    hr = IDXGISwapChain2_SetSourceSize(swapchain2, (UINT)swapchain->width, (UINT)swapchain->height);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+    _SOKOL_UNUSED(hr);
+
+    IDXGISwapChain2_Release(swapchain2);
+    ctx->source_size = (sgg_size){swapchain->width, swapchain->height};
+  }
+
+  if (ctx->msaa_view) {
+    swapchain->d3d11.render_view  = ctx->msaa_view;
+    swapchain->d3d11.resolve_view = ctx->render_target_view;
+  } else {
+    swapchain->d3d11.render_view = ctx->render_target_view;
+  }
+  swapchain->d3d11.depth_stencil_view = ctx->depth_stencil_view;
+}
+
+static void sgg__platform_present(sgg__state* state, sgg__context* ctx, bool vsync) {
+  _SOKOL_UNUSED(state);
+
+  // With the flip model, sync interval 0 replaces the queued frame instead of
+  // waiting (mailbox), and only tears with `DXGI_PRESENT_ALLOW_TEARING`.
+  UINT sync_interval = vsync && ctx->present_mode == SGG_PRESENT_MODE_FIFO ? 1 : 0;
+  UINT flags         = ctx->present_mode == SGG_PRESENT_MODE_IMMEDIATE ? DXGI_PRESENT_ALLOW_TEARING : 0;
+
+  // Occluded swapchains return right away, so the frames are only tested until
+  // the window shows up again, instead of spinning.
+  // Only `DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL` supports dirty rectangles. They're
+  // relative to the back buffer's contents, presented as many frames ago as
+  // there are buffers, so the damage is accumulated over those frames.
+  bool        occluded = sgg__atomic_load_u32(&ctx->occluded) != 0;
+  sgg__damage damage;
+  HRESULT     hr;
+
+  if (ctx->desc.partial_present && !occluded && sgg__accumulate_damage(ctx, sgg__swapchain_buffer_count(&ctx->desc), &damage)) {
+    RECT dirty_rects[SGG_MAX_DAMAGE_RECTS];
+    for (int i = 0; i < damage.count; i++) {
+      const sgg_rect* rect = &damage.rects[i];
+      dirty_rects[i]       = (RECT){rect->x, rect->y, rect->x + rect->width, rect->y + rect->height};
+    }
+
+    DXGI_PRESENT_PARAMETERS params = {
+      .DirtyRectsCount = (UINT)damage.count,
+      .pDirtyRects     = dirty_rects,
+    };
+    hr = IDXGISwapChain1_Present1(ctx->swapchain, sync_interval, flags, &params);
+  } else {
+    hr = IDXGISwapChain1_Present(ctx->swapchain, sync_interval, occluded ? DXGI_PRESENT_TEST : flags);
+  }
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  sgg__atomic_store_u32(&ctx->occluded, hr == DXGI_STATUS_OCCLUDED ? 1 : 0);
+  if (occluded && hr != DXGI_STATUS_OCCLUDED) {
+    // The tested frame wasn't shown.
+    sgg__atomic_store_u32(&ctx->invalidated, 1);
+  }
+}
+
+static bool sgg__platform_visible(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  if (!sgg__atomic_load_u32(&ctx->occluded)) {
+    return true;
+  }
+
+  HRESULT hr = IDXGISwapChain1_Present(ctx->swapchain, 0, DXGI_PRESENT_TEST);
+  if (hr == DXGI_STATUS_OCCLUDED) {
+    return false;
+  }
+
+  sgg__atomic_store_u32(&ctx->occluded, 0);
+  sgg__atomic_store_u32(&ctx->invalidated, 1);
+  return true;
+}
+
+static bool sgg__platform_vblank_time(sgg__state* state, sgg__context* ctx, double* time_ms) {
+  // Fails until the first frames are on screen, or while the window is being
+  // composed without the flip model (e.g., being resized).
+  DXGI_FRAME_STATISTICS stats;
+  if (FAILED(IDXGISwapChain1_GetFrameStatistics(ctx->swapchain, &stats)) || stats.SyncQPCTime.QuadPart == 0) {
+    return false;
+  }
+
+  // GLFW's timer is the performance counter on Windows.
+  *time_ms = (double)stats.SyncQPCTime.QuadPart * state->timer_period_ms;
+  return true;
+}
+
+static void sgg__platform_wait_for_frame(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  DWORD result = WaitForSingleObjectEx(ctx->frame_latency_waitable, 1000, TRUE);
+  SOKOL_ASSERT(result != WAIT_FAILED);
+  _SOKOL_UNUSED(result);
+}
+
+static void sgg__platform_destroy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  if (readback->texture) {
+    ID3D11Texture2D_Release(readback->texture);
+    readback->texture = NULL;
+  }
+}
+
+static bool sgg__platform_copy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  if (!ctx->render_target_view) {
+    return false;
+  }
+
+  if (readback->texture_width != readback->width || readback->texture_height != readback->height) {
+    sgg__platform_destroy_readback(state, ctx, readback);
+  }
+
+  if (!readback->texture) {
+    D3D11_TEXTURE2D_DESC staging_desc = {
+      .Width            = (UINT)readback->width,
+      .Height           = (UINT)readback->height,
+      .MipLevels        = 1,
+      .ArraySize        = 1,
+      .Format           = DXGI_FORMAT_B8G8R8A8_UNORM,
+      .SampleDesc.Count = 1,
+      .Usage            = D3D11_USAGE_STAGING,
+      .CPUAccessFlags   = D3D11_CPU_ACCESS_READ,
+    };
+    HRESULT hr = ID3D11Device_CreateTexture2D(state->device, &staging_desc, NULL, &readback->texture);
+    SOKOL_ASSERT(SUCCEEDED(hr));
+    _SOKOL_UNUSED(hr);
+
+    readback->texture_width  = readback->width;
+    readback->texture_height = readback->height;
+  }
+
+  // With the flip model, the backbuffer is discarded in `Present`, so the copy
+  // has to be recorded before it (MSAA is already resolved by then).
+  ID3D11Texture2D* backbuffer;
+  HRESULT          hr = IDXGISwapChain1_GetBuffer(ctx->swapchain, 0, &IID_ID3D11Texture2D, (void**)&backbuffer);
+  SOKOL_ASSERT(SUCCEEDED(hr));
+  _SOKOL_UNUSED(hr);
+
+  D3D11_BOX box = {0, 0, 0, (UINT)readback->width, (UINT)readback->height, 1};
+  ID3D11DeviceContext_CopySubresourceRegion(state->base_device_context, (ID3D11Resource*)readback->texture, 0, 0, 0, 0, (ID3D11Resource*)backbuffer, 0, &box);
+
+  ID3D11Texture2D_Release(backbuffer);
+  return true;
+}
+
+static bool sgg__platform_map_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback, sgg_readback* result) {
+  _SOKOL_UNUSED(ctx);
+  D3D11_MAPPED_SUBRESOURCE mapped;
+  HRESULT                  hr = ID3D11DeviceContext_Map(state->base_device_context, (ID3D11Resource*)readback->texture, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+  if (hr == DXGI_ERROR_WAS_STILL_DRAWING) {
+    return false;
+  }
+  SOKOL_ASSERT(SUCCEEDED(hr));
+
+  result->pixels    = mapped.pData;
+  result->row_pitch = (int)mapped.RowPitch;
+  return true;
+}
+
+static void sgg__platform_unmap_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(ctx);
+  ID3D11DeviceContext_Unmap(state->base_device_context, (ID3D11Resource*)readback->texture, 0);
+}
+
+static void sgg__platform_shutdown_context(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  sgg__d3d11_release_attachments(ctx);
+  CloseHandle(ctx->frame_latency_waitable);
+  IDXGISwapChain1_Release(ctx->swapchain);
+}
+
+static void sgg__platform_shutdown(sgg__state* state) {
+  IDXGIFactory2_Release(state->factory);
+  ID3D11Device_Release(state->base_device);
+  ID3D11DeviceContext_Release(state->base_device_context);
+  ID3D11Device1_Release(state->device);
+  ID3D11DeviceContext1_Release(state->device_context);
+
+#  ifdef SOKOL_DEBUG
+  IDXGIDebug* debug;
+  if (SUCCEEDED(DXGIGetDebugInterface1(0, &IID_IDXGIDebug, (void**)&debug))) {
+    debug->lpVtbl->ReportLiveObjects(debug, DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_DETAIL);
+    debug->lpVtbl->Release(debug);
+  }
+#  endif // SOKOL_DEBUG
+}
+#elif defined(SOKOL_METAL)
+static void sgg__platform_init_device(sgg__state* state) {
+  state->device = MTLCreateSystemDefaultDevice();
+}
+
+static void sgg__platform_begin_init_device(sgg__state* state) {
+  state->device_group = dispatch_group_create();
+  dispatch_group_async(state->device_group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    sgg__platform_init_device(state);
+  });
+}
+
+static void sgg__platform_wait_device(sgg__state* state) {
+  if (state->device_group) {
+    dispatch_group_wait(state->device_group, DISPATCH_TIME_FOREVER);
+    state->device_group = nil;
+  }
+}
+
+static bool sgg__platform_init(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+  return true;
+}
+
+static sgg_present_mode sgg__platform_present_mode(const sgg__state* state, sgg_present_mode mode) {
+  // The layer either waits for the vertical blank or not, whether the frames
+  // tear is up to the compositor.
+  _SOKOL_UNUSED(state);
+  switch (mode) {
+  case SGG_PRESENT_MODE_FIFO_RELAXED:
+  case SGG_PRESENT_MODE_MAILBOX:
+    return SGG_PRESENT_MODE_FIFO;
+  default:
+    return mode;
+  }
+}
+
+static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
+  env->metal.device = (__bridge const void*)state->device;
+}
+
+static void sgg__platform_render_thread_begin(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_render_thread_end(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_init_context(sgg__state* state, sgg__context* ctx) {
+  CAMetalLayer* layer      = [CAMetalLayer layer];
+  layer.opaque             = YES;
+  layer.device             = state->device;
+  layer.pixelFormat        = MTLPixelFormatBGRA8Unorm;
+  layer.displaySyncEnabled = ctx->present_mode == SGG_PRESENT_MODE_FIFO;
+
+  layer.maximumDrawableCount = (NSUInteger)sgg__swapchain_buffer_count(&ctx->desc);
+
+  // Scaled drawables are stretched over the whole layer.
+  if (ctx->desc.adaptive_resolution) {
+    layer.contentsGravity = kCAGravityResize;
+  }
+
+  NSWindow* ns_window              = glfwGetCocoaWindow(ctx->desc.window);
+  ns_window.contentView.layer      = layer;
+  ns_window.contentView.wantsLayer = YES;
+
+  // The occlusion state can only be read on the main thread, so it's mirrored
+  // for the render thread.
+  ctx->occluded           = (ns_window.occlusionState & NSWindowOcclusionStateVisible) ? 0 : 1;
+  ctx->occlusion_observer = [[NSNotificationCenter defaultCenter]
+    addObserverForName:NSWindowDidChangeOcclusionStateNotification
+                object:ns_window
+                 queue:nil
+            usingBlock:^(NSNotification* notification) {
+              NSWindow* window  = notification.object;
+              bool      visible = (window.occlusionState & NSWindowOcclusionStateVisible) != 0;
+              sgg__atomic_store_u32(&ctx->occluded, visible ? 0 : 1);
+              if (visible) {
+                sgg__atomic_store_u32(&ctx->invalidated, 1);
+              }
+            }];
+
+  ctx->layer           = layer;
+  ctx->drawable        = nil;
+  ctx->frame_semaphore = dispatch_semaphore_create(sgg__max_frames_in_flight(&ctx->desc));
+}
+
+static id<MTLTexture> sgg__mtl_make_render_target(sgg__state* state, MTLPixelFormat format, int width, int height, int sample_count) {
+  MTLTextureDescriptor* desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format
+                                                                                  width:(NSUInteger)width
+                                                                                 height:(NSUInteger)height
+                                                                              mipmapped:NO];
+  desc.textureType           = sample_count > 1 ? MTLTextureType2DMultisample : MTLTextureType2D;
+  desc.sampleCount           = (NSUInteger)sample_count;
+  desc.usage                 = MTLTextureUsageRenderTarget;
+  desc.storageMode           = MTLStorageModePrivate;
+
+  return [state->device newTextureWithDescriptor:desc];
+}
+
+static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, sgg__context* ctx, int width, int height) {
+  ctx->layer.drawableSize    = CGSizeMake(width, height);
+  ctx->msaa_texture          = nil;
+  ctx->depth_stencil_texture = nil;
+
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  int sample_count = sgg__sample_count(&ctx->desc);
+  SOKOL_ASSERT([state->device supportsTextureSampleCount:(NSUInteger)sample_count]);
+
+  if (sample_count > 1) {
+    ctx->msaa_texture = sgg__mtl_make_render_target(state, MTLPixelFormatBGRA8Unorm, width, height, sample_count);
+  }
+
+  if (ctx->desc.depth_format != SGG_DEPTH_FORMAT_NONE) {
+    MTLPixelFormat format      = ctx->desc.depth_format == SGG_DEPTH_FORMAT_DEPTH ? MTLPixelFormatDepth32Float : MTLPixelFormatDepth32Float_Stencil8;
+    ctx->depth_stencil_texture = sgg__mtl_make_render_target(state, format, width, height, sample_count);
+  }
+}
+
+static void sgg__platform_swapchain(sgg__state* state, sgg__context* ctx, sg_swapchain* swapchain) {
+  _SOKOL_UNUSED(state);
+  ctx->drawable = [ctx->layer nextDrawable];
+
+  if (ctx->drawable) {
+    sgg__atomic_u64* presented_time_ns = &ctx->presented_time_ns;
+    [ctx->drawable addPresentedHandler:^(id<MTLDrawable> drawable) {
+      if (drawable.presentedTime > 0.0) {
+        (void)sgg__atomic_exchange_u64(presented_time_ns, (uint64_t)(drawable.presentedTime * 1e9));
+      }
+    }];
+  }
+
+  swapchain->metal.current_drawable      = (__bridge const void*)ctx->drawable;
+  swapchain->metal.msaa_color_texture    = (__bridge const void*)ctx->msaa_texture;
+  swapchain->metal.depth_stencil_texture = (__bridge const void*)ctx->depth_stencil_texture;
+}
+
+static void sgg__platform_present(sgg__state* state, sgg__context* ctx, bool vsync) {
+  // The drawable is presented by sokol_gfx in `sg_commit`, and the layers don't
+  // block the CPU, so there's nothing to batch. A changed present mode applies
+  // from the next drawable on.
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(vsync);
+  ctx->drawable = nil;
+
+  // The frame slot taken in `sgg_wait_for_frame` is given back once the GPU is
+  // done with the frame, whether its drawable was presented or not. An empty
+  // command buffer on sokol_gfx's queue completes right after the frame's one.
+  // Frames dropped before `sgg_present` keep the slot for the next one.
+  if (ctx->frame_slot_acquired) {
+    dispatch_semaphore_t semaphore      = ctx->frame_semaphore;
+    id<MTLCommandBuffer> command_buffer = [_sg.mtl.cmd_queue commandBuffer];
+    [command_buffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+      _SOKOL_UNUSED(buffer);
+      dispatch_semaphore_signal(semaphore);
+    }];
+    [command_buffer commit];
+    ctx->frame_slot_acquired = false;
+  }
+
+  BOOL display_sync = ctx->present_mode == SGG_PRESENT_MODE_FIFO;
+  if (ctx->layer.displaySyncEnabled != display_sync) {
+    ctx->layer.displaySyncEnabled = display_sync;
+  }
+}
+
+static bool sgg__platform_visible(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  return !sgg__atomic_load_u32(&ctx->occluded);
+}
+
+static bool sgg__platform_vblank_time(sgg__state* state, sgg__context* ctx, double* time_ms) {
+  _SOKOL_UNUSED(state);
+  uint64_t presented_time_ns = sgg__atomic_exchange_u64(&ctx->presented_time_ns, 0);
+  if (!presented_time_ns) {
+    return false;
+  }
+
+  // GLFW's timer is `mach_absolute_time` on macOS, same as `presentedTime`.
+  *time_ms = (double)presented_time_ns * 1e-6;
+  return true;
+}
+
+static void sgg__platform_wait_for_frame(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  if (!ctx->frame_slot_acquired) {
+    // Bounded, as the D3D11 wait, so that a lost frame can't stall forever.
+    // Without the slot, nothing is given back for the frame.
+    dispatch_time_t timeout  = dispatch_time(DISPATCH_TIME_NOW, 1000 * (int64_t)NSEC_PER_MSEC);
+    ctx->frame_slot_acquired = dispatch_semaphore_wait(ctx->frame_semaphore, timeout) == 0;
+  }
+}
+
+static void sgg__platform_destroy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  readback->buffer         = nil;
+  readback->command_buffer = nil;
+}
+
+static bool sgg__platform_copy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  if (!ctx->drawable) {
+    return false;
+  }
+
+  id<MTLTexture> texture = ctx->drawable.texture;
+  if (texture.framebufferOnly) {
+    ctx->layer.framebufferOnly = NO;
+    return false;
+  }
+
+  NSUInteger row_pitch = (NSUInteger)readback->width * 4;
+  NSUInteger size      = row_pitch * (NSUInteger)readback->height;
+  if (!readback->buffer || readback->buffer.length < size) {
+    readback->buffer = [state->device newBufferWithLength:size options:MTLResourceStorageModeShared];
+  }
+
+  // sokol_gfx doesn't expose its command queue, but its implementation lives in
+  // this translation unit (checked at the top). The drawable's presentation is
+  // already recorded in the frame's command buffer, so the copy can't go before
+  // it. Using the same queue orders the copy after the frame, and before any
+  // later frame that could render to the drawable's texture again, without any
+  // explicit synchronization.
+  id<MTLCommandBuffer>      command_buffer = [_sg.mtl.cmd_queue commandBuffer];
+  id<MTLBlitCommandEncoder> encoder        = [command_buffer blitCommandEncoder];
+  [encoder copyFromTexture:texture
+                 sourceSlice:0
+                 sourceLevel:0
+                sourceOrigin:MTLOriginMake(0, 0, 0)
+                  sourceSize:MTLSizeMake((NSUInteger)readback->width, (NSUInteger)readback->height, 1)
+                    toBuffer:readback->buffer
+           destinationOffset:0
+      destinationBytesPerRow:row_pitch
+    destinationBytesPerImage:size];
+  [encoder endEncoding];
+  [command_buffer commit];
+
+  readback->command_buffer = command_buffer;
+  return true;
+}
+
+static bool sgg__platform_map_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback, sgg_readback* result) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  MTLCommandBufferStatus status = readback->command_buffer.status;
+  if (status != MTLCommandBufferStatusCompleted) {
+    SOKOL_ASSERT(status != MTLCommandBufferStatusError);
+    return false;
+  }
+
+  readback->command_buffer = nil;
+
+  result->pixels    = readback->buffer.contents;
+  result->row_pitch = readback->width * 4;
+  return true;
+}
+
+static void sgg__platform_unmap_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  // Shared buffers stay mapped.
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(readback);
+}
+
+static void sgg__platform_shutdown_context(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  if (ctx->frame_slot_acquired) {
+    dispatch_semaphore_signal(ctx->frame_semaphore);
+  }
+  [[NSNotificationCenter defaultCenter] removeObserver:ctx->occlusion_observer];
+  ctx->occlusion_observer    = nil;
+  ctx->frame_semaphore       = nil;
+  ctx->drawable              = nil;
+  ctx->msaa_texture          = nil;
+  ctx->depth_stencil_texture = nil;
+  ctx->layer                 = nil;
+}
+
+static void sgg__platform_shutdown(sgg__state* state) {
+  state->device = nil;
+}
+#elif defined(SOKOL_GLCORE)
+// All sokol_gfx rendering happens in the context of the main window (the one
+// passed to `sgg_environment`). Other windows have their own contexts (sharing
+// objects with the main one), but sokol_gfx state like VAOs and FBOs isn't
+// shared between GL contexts. So they get an offscreen framebuffer with a shared
+// color renderbuffer instead, which is blitted (and resolved, with MSAA) to the
+// window when presenting. With the adaptive resolution, the main window gets an
+// offscreen framebuffer too, as its default one can't be smaller than itself.
+
+static void sgg__gl_make_current(GLFWwindow* window) {
+  if (glfwGetCurrentContext() != window) {
+    glfwMakeContextCurrent(window);
+  }
+}
+
+#  if !defined(_WIN32)
+// POSIX allows converting the result of `dlsym` to a function pointer, ISO C
+// doesn't.
+static void sgg__egl_load(void* library, const char* name, void* func) {
+  void* symbol = dlsym(library, name);
+  memcpy(func, &symbol, sizeof(symbol));
+}
+#  endif
+
+// Creates the context of the headless mode, see HEADLESS above. EGL is loaded
+// at runtime, so that the windowed mode doesn't depend on it.
+static bool sgg__gl_init_headless(sgg__state* state) {
+#  if defined(_WIN32)
+  _SOKOL_UNUSED(state);
+  return false;
+#  else
+  state->egl_library = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+  if (!state->egl_library) {
+    return false;
+  }
+
+  sgg__egl_proc_func    get_proc_address       = NULL;
+  sgg__egl_string_func  query_string           = NULL;
+  sgg__egl_display_func get_display            = NULL;
+  sgg__egl_init_func    initialize             = NULL;
+  sgg__egl_config_func  choose_config          = NULL;
+  sgg__egl_bind_func    bind_api               = NULL;
+  sgg__egl_context_func create_context         = NULL;
+  sgg__egl_pbuffer_func create_pbuffer_surface = NULL;
+  sgg__egl_load(state->egl_library, "eglGetProcAddress", &get_proc_address);
+  sgg__egl_load(state->egl_library, "eglQueryString", &query_string);
+  sgg__egl_load(state->egl_library, "eglGetDisplay", &get_display);
+  sgg__egl_load(state->egl_library, "eglInitialize", &initialize);
+  sgg__egl_load(state->egl_library, "eglChooseConfig", &choose_config);
+  sgg__egl_load(state->egl_library, "eglBindAPI", &bind_api);
+  sgg__egl_load(state->egl_library, "eglCreateContext", &create_context);
+  sgg__egl_load(state->egl_library, "eglCreatePbufferSurface", &create_pbuffer_surface);
+  sgg__egl_load(state->egl_library, "eglMakeCurrent", &state->egl_make_current);
+  if (!get_proc_address || !query_string || !get_display || !initialize || !choose_config || !bind_api ||
+      !create_context || !create_pbuffer_surface || !state->egl_make_current) {
+    return false;
+  }
+
+  // Client extensions (EGL 1.5 or `EGL_EXT_client_extensions`) pick the
+  // platform, the default display is whatever the driver chooses.
+  const char*            client_extensions    = query_string(NULL, SGG__EGL_EXTENSIONS);
+  sgg__egl_platform_func get_platform_display = NULL;
+  sgg__egl_devices_func  query_devices        = NULL;
+  if (client_extensions && strstr(client_extensions, "EGL_EXT_platform_base")) {
+    get_platform_display = (sgg__egl_platform_func)get_proc_address("eglGetPlatformDisplayEXT");
+  }
+  if (client_extensions && strstr(client_extensions, "EGL_EXT_device_enumeration")) {
+    query_devices = (sgg__egl_devices_func)get_proc_address("eglQueryDevicesEXT");
+  }
+
+  void* displays[3];
+  int   display_count = 0;
+  if (get_platform_display && strstr(client_extensions, "EGL_MESA_platform_surfaceless")) {
+    displays[display_count++] = get_platform_display(SGG__EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+  }
+  void*   device       = NULL;
+  int32_t device_count = 0;
+  if (get_platform_display && query_devices && strstr(client_extensions, "EGL_EXT_platform_device") &&
+      query_devices(1, &device, &device_count) && device_count > 0) {
+    displays[display_count++] = get_platform_display(SGG__EGL_PLATFORM_DEVICE_EXT, device, NULL);
+  }
+  displays[display_count++] = get_display(NULL);
+
+  for (int i = 0; i < display_count && !state->headless_display; i++) {
+    if (displays[i] && initialize(displays[i], NULL, NULL)) {
+      state->headless_display = displays[i];
+    }
+  }
+  if (!state->headless_display) {
+    return false;
+  }
+
+  // All rendering goes to the offscreen framebuffer, the surface (if any) is
+  // never drawn to.
+  const char* extensions  = query_string(state->headless_display, SGG__EGL_EXTENSIONS);
+  bool        surfaceless = extensions && strstr(extensions, "EGL_KHR_surfaceless_context");
+
+  const int32_t config_attributes[] = {
+    SGG__EGL_SURFACE_TYPE, surfaceless ? 0 : SGG__EGL_PBUFFER_BIT,
+    SGG__EGL_RENDERABLE_TYPE, SGG__EGL_OPENGL_BIT,
+    SGG__EGL_NONE,
+  };
+  void*   config       = NULL;
+  int32_t config_count = 0;
+  if (!choose_config(state->headless_display, config_attributes, &config, 1, &config_count) || config_count == 0 ||
+      !bind_api(SGG__EGL_OPENGL_API)) {
+    return false;
+  }
+
+  static const int32_t versions[][2] = {{4, 3}, {4, 1}};
+  for (int i = 0; i < 2 && !state->headless_context; i++) {
+    const int32_t context_attributes[] = {
+      SGG__EGL_CONTEXT_MAJOR_VERSION, versions[i][0],
+      SGG__EGL_CONTEXT_MINOR_VERSION, versions[i][1],
+      SGG__EGL_CONTEXT_OPENGL_PROFILE_MASK, SGG__EGL_CONTEXT_OPENGL_CORE_PROFILE,
+      SGG__EGL_NONE,
+    };
+    state->headless_context = create_context(state->headless_display, config, NULL, context_attributes);
+  }
+  if (!state->headless_context) {
+    return false;
+  }
+
+  if (!surfaceless) {
+    const int32_t surface_attributes[] = {SGG__EGL_WIDTH, 1, SGG__EGL_HEIGHT, 1, SGG__EGL_NONE};
+    state->headless_surface            = create_pbuffer_surface(state->headless_display, config, surface_attributes);
+    if (!state->headless_surface) {
+      return false;
+    }
+  }
+
+  return state->egl_make_current(state->headless_display, state->headless_surface, state->headless_surface, state->headless_context);
+#  endif
+}
+
+static void sgg__gl_shutdown_headless(sgg__state* state) {
+#  if defined(_WIN32)
+  _SOKOL_UNUSED(state);
+#  else
+  if (!state->egl_library) {
+    return;
+  }
+
+  sgg__egl_destroy_func   destroy_context = NULL;
+  sgg__egl_destroy_func   destroy_surface = NULL;
+  sgg__egl_terminate_func terminate       = NULL;
+  sgg__egl_load(state->egl_library, "eglDestroyContext", &destroy_context);
+  sgg__egl_load(state->egl_library, "eglDestroySurface", &destroy_surface);
+  sgg__egl_load(state->egl_library, "eglTerminate", &terminate);
+
+  if (state->headless_display) {
+    state->egl_make_current(state->headless_display, NULL, NULL, NULL);
+    if (state->headless_context) {
+      destroy_context(state->headless_display, state->headless_context);
+    }
+    if (state->headless_surface) {
+      destroy_surface(state->headless_display, state->headless_surface);
+    }
+    terminate(state->headless_display);
+  }
+
+  dlclose(state->egl_library);
+  state->egl_library      = NULL;
+  state->headless_display = NULL;
+  state->headless_surface = NULL;
+  state->headless_context = NULL;
+#  endif
+}
+
+// Makes the main (or the headless) context current on the calling thread, or
+// releases it.
+static void sgg__gl_bind_main_context(sgg__state* state, bool bind) {
+  if (state->headless_context) {
+    void* surface = bind ? state->headless_surface : NULL;
+    state->egl_make_current(state->headless_display, surface, surface, bind ? state->headless_context : NULL);
+  } else {
+    glfwMakeContextCurrent(bind ? state->main_window : NULL);
+  }
+}
+
+// The GL context comes with the window, there's nothing to create ahead of it.
+static void sgg__platform_init_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_begin_init_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_wait_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static bool sgg__platform_init(sgg__state* state) {
+  state->main_window = state->contexts[0].desc.window;
+
+  if (state->contexts[0].desc.headless) {
+    if (!sgg__gl_init_headless(state)) {
+      sgg__gl_shutdown_headless(state);
+      return false;
+    }
+
+    if (state->render_thread) {
+      // Made current on the render thread in `sgg_render_thread_begin`.
+      sgg__gl_bind_main_context(state, false);
+    }
+    return true;
+  }
+
+  // Extensions can only be queried with a current context.
+  sgg__gl_make_current(state->main_window);
+  state->swap_control_tear = glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                             glfwExtensionSupported("GLX_EXT_swap_control_tear");
+
+  // Damage and buffer age only come with EGL, whose functions GLFW loads too.
+  if (glfwGetWindowAttrib(state->main_window, GLFW_CONTEXT_CREATION_API) == GLFW_EGL_CONTEXT_API) {
+    sgg__egl_string_func query_string = (sgg__egl_string_func)glfwGetProcAddress("eglQueryString");
+
+    state->egl_display     = glfwGetEGLDisplay();
+    const char* extensions = query_string ? query_string(state->egl_display, SGG__EGL_EXTENSIONS) : NULL;
+
+    if (extensions && strstr(extensions, "EGL_KHR_swap_buffers_with_damage")) {
+      state->egl_swap_buffers_with_damage = (sgg__egl_damage_func)glfwGetProcAddress("eglSwapBuffersWithDamageKHR");
+    } else if (extensions && strstr(extensions, "EGL_EXT_swap_buffers_with_damage")) {
+      state->egl_swap_buffers_with_damage = (sgg__egl_damage_func)glfwGetProcAddress("eglSwapBuffersWithDamageEXT");
+    }
+    if (extensions && strstr(extensions, "EGL_EXT_buffer_age")) {
+      state->egl_query_surface = (sgg__egl_query_func)glfwGetProcAddress("eglQuerySurface");
+    }
+  }
+
+  if (state->render_thread) {
+    // Made current on the render thread in `sgg_render_thread_begin`.
+    if (glfwGetCurrentContext() == state->main_window) {
+      glfwMakeContextCurrent(NULL);
+    }
+  } else {
+    sgg__gl_make_current(state->main_window);
+  }
+  return true;
+}
+
+static sgg_present_mode sgg__platform_present_mode(const sgg__state* state, sgg_present_mode mode) {
+  switch (mode) {
+  case SGG_PRESENT_MODE_FIFO_RELAXED:
+    return state->swap_control_tear ? SGG_PRESENT_MODE_FIFO_RELAXED : SGG_PRESENT_MODE_FIFO;
+  case SGG_PRESENT_MODE_MAILBOX:
+    return SGG_PRESENT_MODE_FIFO;
+  default:
+    return mode;
+  }
+}
+
+static void sgg__platform_render_thread_begin(sgg__state* state) {
+  sgg__gl_bind_main_context(state, true);
+}
+
+static void sgg__platform_render_thread_end(sgg__state* state) {
+  sgg__gl_bind_main_context(state, false);
+}
+
+static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
+  // sokol_gfx picks up the context that is current during `sg_setup`.
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(env);
+}
+
+static void sgg__platform_init_context(sgg__state* state, sgg__context* ctx) {
+  ctx->swap_interval = -2; // Not set yet (-1 is adaptive vsync).
+  ctx->egl_surface   = state->egl_display ? glfwGetEGLSurface(ctx->desc.window) : NULL;
+}
+
+static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, sgg__context* ctx, int width, int height) {
+  // The default framebuffer is resized by the window system together with the
+  // window, so there's nothing to (re)allocate here, only to keep track of.
+  // The headless context has no default framebuffer to begin with.
+  bool default_framebuffer = ctx->desc.window == state->main_window && !ctx->desc.adaptive_resolution && !ctx->desc.headless;
+  if (default_framebuffer || width == 0 || height == 0) {
+    return;
+  }
+
+  int samples = sgg__sample_count(&ctx->desc);
+  if (samples == 1) {
+    samples = 0;
+  }
+
+  GLint prev_renderbuffer = 0;
+  glGetIntegerv(GL_RENDERBUFFER_BINDING, &prev_renderbuffer);
+
+  if (!ctx->color_renderbuffer) {
+    glGenRenderbuffers(1, &ctx->color_renderbuffer);
+  }
+  glBindRenderbuffer(GL_RENDERBUFFER, ctx->color_renderbuffer);
+  glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+
+  if (ctx->desc.depth_format != SGG_DEPTH_FORMAT_NONE) {
+    if (!ctx->depth_stencil_renderbuffer) {
+      glGenRenderbuffers(1, &ctx->depth_stencil_renderbuffer);
+    }
+    GLenum format = ctx->desc.depth_format == SGG_DEPTH_FORMAT_DEPTH ? GL_DEPTH_COMPONENT32F : GL_DEPTH24_STENCIL8;
+    glBindRenderbuffer(GL_RENDERBUFFER, ctx->depth_stencil_renderbuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width, height);
+  }
+
+  glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)prev_renderbuffer);
+
+  if (!ctx->framebuffer) {
+    glGenFramebuffers(1, &ctx->framebuffer);
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, ctx->framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ctx->color_renderbuffer);
+  if (ctx->depth_stencil_renderbuffer) {
+    GLenum attachment = ctx->desc.depth_format == SGG_DEPTH_FORMAT_DEPTH ? GL_DEPTH_ATTACHMENT : GL_DEPTH_STENCIL_ATTACHMENT;
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, ctx->depth_stencil_renderbuffer);
+  }
+  SOKOL_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  ctx->blit_framebuffer_stale = true;
+}
+
+static void sgg__platform_swapchain(sgg__state* state, sgg__context* ctx, sg_swapchain* swapchain) {
+  _SOKOL_UNUSED(state);
+  swapchain->gl.framebuffer = ctx->framebuffer;
+}
+
+// Maps a rectangle from the swapchain to the window's framebuffer, with the
+// origin at the bottom-left corner, as `{x, y, width, height}`. Rounded
+// outwards, plus a pixel for the linear filtering when scaled.
+static void sgg__gl_window_rect(const sgg__context* ctx, sgg_rect rect, GLint* result) {
+  sgg_size source = ctx->swapchain_size;
+  int      width  = ctx->framebuffer_width;
+  int      height = ctx->framebuffer_height;
+  int      margin = source.width != width || source.height != height ? 1 : 0;
+
+  int left   = sgg__max(rect.x * width / source.width - margin, 0);
+  int top    = sgg__max(rect.y * height / source.height - margin, 0);
+  int right  = sgg__min(((rect.x + rect.width) * width + source.width - 1) / source.width + margin, width);
+  int bottom = sgg__min(((rect.y + rect.height) * height + source.height - 1) / source.height + margin, height);
+
+  result[0] = left;
+  result[1] = height - bottom;
+  result[2] = right - left;
+  result[3] = bottom - top;
+}
+
+// Age of the window's back buffer in frames (i.e., 1 if it holds the previous
+// frame), or 0 if unknown. The window's context must be current.
+static int sgg__gl_buffer_age(const sgg__state* state, const sgg__context* ctx) {
+  int32_t age = 0;
+  if (!state->egl_query_surface || !ctx->egl_surface ||
+      !state->egl_query_surface(state->egl_display, ctx->egl_surface, SGG__EGL_BUFFER_AGE_EXT, &age)) {
+    return 0;
+  }
+  return (int)age;
+}
+
+static void sgg__gl_swap_buffers(const sgg__state* state, sgg__context* ctx, bool vsync) {
+  int swap_interval = 0;
+  if (vsync && ctx->present_mode == SGG_PRESENT_MODE_FIFO) {
+    swap_interval = 1;
+  } else if (vsync && ctx->present_mode == SGG_PRESENT_MODE_FIFO_RELAXED) {
+    swap_interval = -1;
+  }
+  if (ctx->swap_interval != swap_interval) {
+    ctx->swap_interval = swap_interval;
+    glfwSwapInterval(swap_interval);
+  }
+
+  const sgg__damage* damage = sgg__current_damage(ctx);
+  if (damage && state->egl_swap_buffers_with_damage && ctx->egl_surface) {
+    GLint rects[SGG_MAX_DAMAGE_RECTS * 4];
+    for (int i = 0; i < damage->count; i++) {
+      sgg__gl_window_rect(ctx, damage->rects[i], &rects[i * 4]);
+    }
+    if (state->egl_swap_buffers_with_damage(state->egl_display, ctx->egl_surface, rects, damage->count)) {
+      return;
+    }
+  }
+  glfwSwapBuffers(ctx->desc.window);
+}
+
+static void sgg__gl_insert_frame_fence(sgg__context* ctx) {
+  GLsync* fence = &ctx->frame_fences[ctx->frame_fence_index];
+  if (*fence) {
+    glDeleteSync(*fence);
+  }
+  *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  ctx->frame_fence_index = (ctx->frame_fence_index + 1) % sgg__max_frames_in_flight(&ctx->desc);
+}
+
+// Resolves the multisampled `source` framebuffer into a single-sampled one,
+// (re)allocated on size change. Must be called in the main window's context.
+static GLuint sgg__gl_resolve(sgg__context* ctx, GLuint source, int width, int height) {
+  if (ctx->resolve_size.width != width || ctx->resolve_size.height != height) {
+    GLint prev_renderbuffer = 0;
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &prev_renderbuffer);
+
+    if (!ctx->resolve_renderbuffer) {
+      glGenRenderbuffers(1, &ctx->resolve_renderbuffer);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, ctx->resolve_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, (GLuint)prev_renderbuffer);
+
+    if (!ctx->resolve_framebuffer) {
+      glGenFramebuffers(1, &ctx->resolve_framebuffer);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, ctx->resolve_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, ctx->resolve_renderbuffer);
+    SOKOL_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+    ctx->resolve_size           = (sgg_size){width, height};
+    ctx->blit_framebuffer_stale = true;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, ctx->resolve_framebuffer);
+  glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+  return ctx->resolve_framebuffer;
+}
+
+// Blits the rendered area of `read_framebuffer` to the current context's
+// window, stretching it over the whole window when rendering at lower scale.
+// Only the damage accumulated over the back buffer's age is copied, by
+// scissoring the same (whole) blit, so that the scaled pixels come out exactly
+// as in a whole copy.
+static void sgg__gl_blit_to_window(const sgg__state* state, sgg__context* ctx, GLuint read_framebuffer) {
+  sgg_size source = ctx->swapchain_size;
+  GLenum   filter = source.width != ctx->framebuffer_width || source.height != ctx->framebuffer_height ? GL_LINEAR : GL_NEAREST;
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, read_framebuffer);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+  sgg__damage damage;
+  if (!sgg__accumulate_damage(ctx, sgg__gl_buffer_age(state, ctx), &damage)) {
+    glBlitFramebuffer(0, 0, source.width, source.height, 0, 0, ctx->framebuffer_width, ctx->framebuffer_height, GL_COLOR_BUFFER_BIT, filter);
+    return;
+  }
+
+  GLboolean prev_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
+  GLint     prev_scissor_box[4];
+  glGetIntegerv(GL_SCISSOR_BOX, prev_scissor_box);
+  glEnable(GL_SCISSOR_TEST);
+
+  for (int i = 0; i < damage.count; i++) {
+    GLint rect[4];
+    sgg__gl_window_rect(ctx, damage.rects[i], rect);
+    glScissor(rect[0], rect[1], rect[2], rect[3]);
+    glBlitFramebuffer(0, 0, source.width, source.height, 0, 0, ctx->framebuffer_width, ctx->framebuffer_height, GL_COLOR_BUFFER_BIT, filter);
+  }
+
+  if (!prev_scissor_test) {
+    glDisable(GL_SCISSOR_TEST);
+  }
+  glScissor(prev_scissor_box[0], prev_scissor_box[1], prev_scissor_box[2], prev_scissor_box[3]);
+}
+
+static void sgg__platform_present(sgg__state* state, sgg__context* ctx, bool vsync) {
+  bool main_window = ctx->desc.window == state->main_window;
+
+  // Nothing to show, the frame only has to be submitted.
+  if (ctx->desc.headless) {
+    sgg__gl_insert_frame_fence(ctx);
+    glFlush();
+    return;
+  }
+
+  // Swapping the buffers of a minimized window doesn't wait for the vertical
+  // blank (with some drivers), so the frame is dropped instead.
+  if (sgg__atomic_load_u32(&ctx->iconified)) {
+    sgg__gl_insert_frame_fence(ctx);
+    return;
+  }
+
+  if (!ctx->framebuffer) {
+    if (main_window) {
+      sgg__gl_swap_buffers(state, ctx, vsync);
+      sgg__gl_insert_frame_fence(ctx);
+    }
+    return;
+  }
+
+  // Multisampled framebuffers can only be blitted without scaling, and into
+  // the (possibly multisampled) main window only with matching sample counts,
+  // so these get resolved first.
+  GLuint framebuffer  = ctx->framebuffer;
+  GLuint renderbuffer = ctx->color_renderbuffer;
+  bool   scaled       = ctx->swapchain_size.width != ctx->framebuffer_width ||
+                  ctx->swapchain_size.height != ctx->framebuffer_height;
+  if (sgg__sample_count(&ctx->desc) > 1 && (main_window || scaled)) {
+    framebuffer  = sgg__gl_resolve(ctx, framebuffer, ctx->swapchain_size.width, ctx->swapchain_size.height);
+    renderbuffer = ctx->resolve_renderbuffer;
+  }
+
+  if (main_window) {
+    sgg__gl_blit_to_window(state, ctx, framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    sgg__gl_swap_buffers(state, ctx, vsync);
+    sgg__gl_insert_frame_fence(ctx);
+    return;
+  }
+
+  GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush();
+
+  sgg__gl_make_current(ctx->desc.window);
+  glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+  glDeleteSync(fence);
+
+  if (!ctx->blit_framebuffer) {
+    glGenFramebuffers(1, &ctx->blit_framebuffer);
+  }
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, ctx->blit_framebuffer);
+  if (ctx->blit_framebuffer_stale || ctx->blit_renderbuffer != renderbuffer) {
+    glFramebufferRenderbuffer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+    ctx->blit_renderbuffer      = renderbuffer;
+    ctx->blit_framebuffer_stale = false;
+  }
+  sgg__gl_blit_to_window(state, ctx, ctx->blit_framebuffer);
+
+  sgg__gl_swap_buffers(state, ctx, vsync);
+  sgg__gl_make_current(state->main_window);
+  sgg__gl_insert_frame_fence(ctx);
+}
+
+static bool sgg__platform_visible(sgg__state* state, sgg__context* ctx) {
+  // Neither X11 nor Wayland reports occlusion through GLFW.
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  return true;
+}
+
+static bool sgg__platform_vblank_time(sgg__state* state, sgg__context* ctx, double* time_ms) {
+  // Would need `GLX_OML_sync_control`, which GLFW doesn't expose.
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(time_ms);
+  return false;
+}
+
+static void sgg__platform_wait_for_frame(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+
+  // The oldest fence, i.e., the one of the frame `max_frames_in_flight` ago.
+  GLsync* fence = &ctx->frame_fences[ctx->frame_fence_index];
+  if (*fence) {
+    GLenum result = glClientWaitSync(*fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    SOKOL_ASSERT(result != GL_WAIT_FAILED);
+    _SOKOL_UNUSED(result);
+    glDeleteSync(*fence);
+    *fence = NULL;
+  }
+}
+
+static void sgg__platform_destroy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  if (readback->fence) {
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+  }
+  if (readback->buffer) {
+    glDeleteBuffers(1, &readback->buffer);
+    readback->buffer      = 0;
+    readback->buffer_size = 0;
+  }
+}
+
+// Multisampled framebuffers can't be read from directly, so they're resolved
+// into a single-sampled one first. Returns the resolved framebuffer.
+static bool sgg__platform_copy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  // Called before the swap, in the main window's context, where the other
+  // windows' offscreen framebuffers live too.
+  GLuint source = ctx->framebuffer;
+  if (ctx->desc.window != state->main_window && !source) {
+    return false;
+  }
+
+  if (sgg__sample_count(&ctx->desc) > 1) {
+    source = sgg__gl_resolve(ctx, source, readback->width, readback->height);
+  }
+
+  GLsizeiptr size = (GLsizeiptr)readback->width * readback->height * 4;
+  if (!readback->buffer) {
+    glGenBuffers(1, &readback->buffer);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+  if (readback->buffer_size < size) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    readback->buffer_size = size;
+  }
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+  glReadPixels(0, 0, readback->width, readback->height, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  if (readback->fence) {
+    glDeleteSync(readback->fence);
+  }
+  readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  return true;
+}
+
+static bool sgg__platform_map_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback, sgg_readback* result) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  if (readback->fence) {
+    GLenum status = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+      return false;
+    }
+    SOKOL_ASSERT(status != GL_WAIT_FAILED);
+    glDeleteSync(readback->fence);
+    readback->fence = NULL;
+  }
+
+  GLsizeiptr size = (GLsizeiptr)readback->width * readback->height * 4;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+  result->pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  SOKOL_ASSERT(result->pixels);
+
+  result->row_pitch = readback->width * 4;
+  result->bottom_up = true;
+  return true;
+}
+
+static void sgg__platform_unmap_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->buffer);
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+static void sgg__platform_shutdown_context(sgg__state* state, sgg__context* ctx) {
+  for (int i = 0; i < SGG__MAX_FRAMES_IN_FLIGHT; i++) {
+    if (ctx->frame_fences[i]) {
+      glDeleteSync(ctx->frame_fences[i]);
+    }
+  }
+  if (ctx->resolve_framebuffer) {
+    glDeleteFramebuffers(1, &ctx->resolve_framebuffer);
+  }
+  if (ctx->resolve_renderbuffer) {
+    glDeleteRenderbuffers(1, &ctx->resolve_renderbuffer);
+  }
+
+  if (ctx->desc.window == state->main_window && !ctx->desc.headless) {
+    return;
+  }
+
+  if (ctx->blit_framebuffer) {
+    sgg__gl_make_current(ctx->desc.window);
+    glDeleteFramebuffers(1, &ctx->blit_framebuffer);
+    sgg__gl_make_current(state->main_window);
+  }
+  if (ctx->framebuffer) {
+    glDeleteFramebuffers(1, &ctx->framebuffer);
+  }
+  if (ctx->color_renderbuffer) {
+    glDeleteRenderbuffers(1, &ctx->color_renderbuffer);
+  }
+  if (ctx->depth_stencil_renderbuffer) {
+    glDeleteRenderbuffers(1, &ctx->depth_stencil_renderbuffer);
+  }
+}
+
+static void sgg__platform_shutdown(sgg__state* state) {
+  if (state->egl_library) {
+    sgg__gl_shutdown_headless(state);
+  } else if (glfwGetCurrentContext() == state->main_window) {
+    glfwMakeContextCurrent(NULL);
+  }
+}
+#elif defined(SOKOL_DUMMY_BACKEND)
+static void sgg__platform_init_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_begin_init_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_wait_device(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static bool sgg__platform_init(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+  return true;
+}
+
+static sgg_present_mode sgg__platform_present_mode(const sgg__state* state, sgg_present_mode mode) {
+  _SOKOL_UNUSED(state);
+  return mode;
+}
+
+static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(env);
+}
+
+static void sgg__platform_render_thread_begin(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_render_thread_end(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+
+static void sgg__platform_init_context(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  ctx->width  = 0;
+  ctx->height = 0;
+}
+
+static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, sgg__context* ctx, int width, int height) {
+  _SOKOL_UNUSED(state);
+  ctx->width  = width;
+  ctx->height = height;
+}
+
+static void sgg__platform_swapchain(sgg__state* state, sgg__context* ctx, sg_swapchain* swapchain) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(swapchain);
+}
+
+static void sgg__platform_present(sgg__state* state, sgg__context* ctx, bool vsync) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(vsync);
+}
+
+static bool sgg__platform_visible(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  return true;
+}
+
+static bool sgg__platform_vblank_time(sgg__state* state, sgg__context* ctx, double* time_ms) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(time_ms);
+  return false;
+}
+
+static void sgg__platform_wait_for_frame(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+}
+
+// There's nothing to read back, so zeroed pixels are handed out right away, to
+// exercise the rest of the readback path.
+
+static void sgg__platform_destroy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  free(readback->pixels);
+  readback->pixels      = NULL;
+  readback->pixels_size = 0;
+}
+
+static bool sgg__platform_copy_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  size_t size = (size_t)readback->width * (size_t)readback->height * 4;
+  if (readback->pixels_size < size) {
+    sgg__platform_destroy_readback(state, ctx, readback);
+    readback->pixels = calloc(size, 1);
+    SOKOL_ASSERT(readback->pixels);
+    readback->pixels_size = size;
+  }
+  return true;
+}
+
+static bool sgg__platform_map_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback, sgg_readback* result) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  result->pixels    = readback->pixels;
+  result->row_pitch = readback->width * 4;
+  return true;
+}
+
+static void sgg__platform_unmap_readback(sgg__state* state, sgg__context* ctx, sgg__readback* readback) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+  _SOKOL_UNUSED(readback);
+}
+
+static void sgg__platform_shutdown_context(sgg__state* state, sgg__context* ctx) {
+  _SOKOL_UNUSED(state);
+  _SOKOL_UNUSED(ctx);
+}
+
+static void sgg__platform_shutdown(sgg__state* state) {
+  _SOKOL_UNUSED(state);
+}
+#endif // SOKOL_* backend
+
+#ifdef SGG_ENABLE_FRAME_STATS
+#  define SGG__TIMED(ctx, ring, statement)                                     \
+    do {                                                                       \
+      uint64_t sgg__start = glfwGetTimerValue();                               \
+      statement;                                                               \
+      sgg__timing_push(&(ctx)->stats.ring, glfwGetTimerValue() - sgg__start); \
+    } while (0)
+
+static void sgg__timing_push(sgg__timing_ring* ring, uint64_t ticks) {
+  ring->samples[ring->next] = (double)ticks * g_sgg_state.timer_period_ms;
+  ring->next                = (ring->next + 1) % SGG_FRAME_STATS_HISTORY;
+  if (ring->count < SGG_FRAME_STATS_HISTORY) {
+    ring->count++;
+  }
+}
+
+static int sgg__compare_doubles(const void* lhs, const void* rhs) {
+  double a = *(const double*)lhs;
+  double b = *(const double*)rhs;
+  return (a > b) - (a < b);
+}
+
+static sgg_timing_stats sgg__timing_summary(const sgg__timing_ring* ring) {
+  sgg_timing_stats stats = {0};
+  if (!ring->count) {
+    return stats;
+  }
+
+  double sorted[SGG_FRAME_STATS_HISTORY];
+  double sum = 0.0;
+  for (uint32_t i = 0; i < ring->count; i++) {
+    sorted[i] = ring->samples[i];
+    sum += sorted[i];
+  }
+  qsort(sorted, ring->count, sizeof(double), sgg__compare_doubles);
+
+  stats.last_ms = ring->samples[(ring->next + SGG_FRAME_STATS_HISTORY - 1) % SGG_FRAME_STATS_HISTORY];
+  stats.min_ms  = sorted[0];
+  stats.avg_ms  = sum / ring->count;
+  stats.p99_ms  = sorted[(ring->count * 99 - 1) / 100];
+
+  return stats;
+}
+#else
+#  define SGG__TIMED(ctx, ring, statement) statement
+#endif // SGG_ENABLE_FRAME_STATS
+
+#ifdef SGG_ENABLE_TRACE
+#  define SGG__TRACE_BEGIN(name) sgg__trace_record(name)
+#  define SGG__TRACE_END()       sgg__trace_record(NULL)
+
+static sgg__trace_buffer* sgg__claim_trace_buffer(void) {
+  // Don't keep bumping the count from every untraced thread.
+  if (sgg__atomic_load_u32(&g_sgg_trace.thread_count) >= SGG_TRACE_MAX_THREADS) {
+    return NULL;
+  }
+
+  uint32_t index = sgg__atomic_add_u32(&g_sgg_trace.thread_count, 1);
+  if (index >= SGG_TRACE_MAX_THREADS) {
+    return NULL;
+  }
+
+  g_sgg_trace_buffer = &g_sgg_trace.buffers[index];
+  return g_sgg_trace_buffer;
+}
+
+static void sgg__trace_record(const char* name) {
+  sgg__trace_buffer* buffer = g_sgg_trace_buffer;
+  if (!buffer && !(buffer = sgg__claim_trace_buffer())) {
+    return;
+  }
+
+  uint32_t index = buffer->next++;
+
+  buffer->events[index & (SGG_TRACE_EVENT_COUNT - 1)] = (sgg__trace_event){glfwGetTimerValue(), name};
+  sgg__atomic_store_u32(&buffer->count, index + 1);
+}
+
+// Copies the thread's events to `events` (`SGG_TRACE_EVENT_COUNT` long), oldest
+// first, and returns their count. Events the owning thread might have
+// overwritten during the copy are left out.
+static uint32_t sgg__copy_trace_events(sgg__trace_buffer* buffer, sgg__trace_event* events) {
+  // A single load, so `count` can't exceed the ring however far the owning
+  // thread gets meanwhile.
+  uint32_t end   = sgg__atomic_load_u32(&buffer->count);
+  uint32_t count = end < SGG_TRACE_EVENT_COUNT ? end : SGG_TRACE_EVENT_COUNT;
+
+  for (uint32_t i = 0; i < count; i++) {
+    events[i] = buffer->events[(end - count + i) & (SGG_TRACE_EVENT_COUNT - 1)];
+  }
+
+  sgg__atomic_fence();
+
+  // Published since, plus the one possibly being stored.
+  uint32_t overwritten = sgg__atomic_load_u32(&buffer->count) - end + 1;
+  uint32_t unused      = SGG_TRACE_EVENT_COUNT - count;
+  uint32_t lost        = overwritten > unused ? overwritten - unused : 0;
+
+  if (lost >= count) {
+    return 0;
+  }
+  if (lost > 0) {
+    memmove(events, events + lost, (size_t)(count - lost) * sizeof(sgg__trace_event));
+  }
+  return count - lost;
+}
+
+static void sgg__write_json_string(FILE* file, const char* string) {
+  fputc('"', file);
+  for (const char* c = string; *c; c++) {
+    if (*c == '"' || *c == '\\') {
+      fputc('\\', file);
+      fputc(*c, file);
+    } else if ((unsigned char)*c >= 0x20) {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static bool sgg__write_trace(const char* path) {
+  sgg__trace_event* events = (sgg__trace_event*)malloc(SGG_TRACE_EVENT_COUNT * sizeof(sgg__trace_event));
+  if (!events) {
+    return false;
+  }
+
+  FILE* file = fopen(path, "w");
+  if (!file) {
+    free(events);
+    return false;
+  }
+
+  double   us_per_tick  = 1e6 / (double)glfwGetTimerFrequency();
+  uint32_t thread_count = sgg__atomic_load_u32(&g_sgg_trace.thread_count);
+  bool     first        = true;
+
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+  for (uint32_t thread = 0; thread < thread_count && thread < SGG_TRACE_MAX_THREADS; thread++) {
+    uint32_t count = sgg__copy_trace_events(&g_sgg_trace.buffers[thread], events);
+    int      depth = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+      const sgg__trace_event* event = &events[i];
+
+      // Ends of the spans whose beginnings are no longer in the ring.
+      if (!event->name && depth == 0) {
+        continue;
+      }
+      depth += event->name ? 1 : -1;
+
+      fprintf(file, "%s\n  {", first ? "" : ",");
+      if (event->name) {
+        fprintf(file, "\"name\": ");
+        sgg__write_json_string(file, event->name);
+        fprintf(file, ", ");
+      }
+      fprintf(
+        file,
+        "\"ph\": \"%c\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f}",
+        event->name ? 'B' : 'E',
+        thread + 1,
+        (double)event->ticks * us_per_tick);
+      first = false;
+    }
+  }
+
+  fprintf(file, "\n]}\n");
+
+  bool ok = !ferror(file);
+  ok      = fclose(file) == 0 && ok;
+  free(events);
+  return ok;
+}
+#else
+#  define SGG__TRACE_BEGIN(name) ((void)0)
+#  define SGG__TRACE_END()       ((void)0)
+#endif // SGG_ENABLE_TRACE
+
+static int sgg__grow_size(sgg_resize_policy policy, int size) {
+  int step = 64;
+
+  switch (policy) {
+  case SGG_RESIZE_POLICY_GROW_POW2:
+    while (step < size) {
+      step *= 2;
+    }
+    return step;
+
+  case SGG_RESIZE_POLICY_GROW_1_5X:
+    while (step < size) {
+      step += (step + 1) / 2;
+    }
+    return step;
+
+  default:
+    return size;
+  }
+}
+
+static bool sgg__fits_max_bytes(const sgg_environment_desc* desc, sgg_size size) {
+  return !desc->backbuffer_max_bytes || sgg__backbuffer_bytes(desc, size.width, size.height) <= desc->backbuffer_max_bytes;
+}
+
+// Returns the backbuffer size the current one should be changed to, when the
+// window framebuffer has the given size.
+static sgg_size sgg__resolve_backbuffer_size(sgg__context* ctx, sgg_size current, sgg_size framebuffer, double now) {
+  const sgg_environment_desc* desc = &ctx->desc;
+
+  sgg_size required = {
+    sgg__max(framebuffer.width, desc->backbuffer_min_width),
+    sgg__max(framebuffer.height, desc->backbuffer_min_height),
+  };
+  if (desc->backbuffer_fit_monitor) {
+    required.width  = sgg__max(required.width, ctx->monitor_size.width);
+    required.height = sgg__max(required.height, ctx->monitor_size.height);
+  }
+  if (!sgg__fits_max_bytes(desc, required)) {
+    required = framebuffer;
+  }
+
+  if (desc->resize_policy == SGG_RESIZE_POLICY_CUSTOM) {
+    SOKOL_ASSERT(desc->resize_func);
+    sgg_size size = desc->resize_func(current, required, desc->resize_user_data);
+    SOKOL_ASSERT(size.width >= required.width && size.height >= required.height);
+    return size;
+  }
+
+  sgg_size target = {
+    sgg__grow_size(desc->resize_policy, required.width),
+    sgg__grow_size(desc->resize_policy, required.height),
+  };
+  if (!sgg__fits_max_bytes(desc, target)) {
+    target = required;
+  }
+
+  // Growing is never deferred, but the backbuffer keeps its size along the other
+  // axis, unless it can shrink as well.
+  sgg_size grown = {
+    sgg__max(current.width, target.width),
+    sgg__max(current.height, target.height),
+  };
+
+  bool can_shrink   = !desc->backbuffer_never_downsize || !sgg__fits_max_bytes(desc, grown);
+  bool wants_shrink = target.width < current.width || target.height < current.height;
+
+  if (!can_shrink || !wants_shrink) {
+    ctx->shrink_pending_frames = 0;
+    return grown;
+  }
+
+  if (ctx->shrink_pending_frames++ == 0 && desc->backbuffer_shrink_delay_ms > 0.0) {
+    ctx->shrink_pending_since = now;
+  }
+
+  bool delay_passed = ctx->shrink_pending_frames > desc->backbuffer_shrink_delay_frames;
+  if (delay_passed && desc->backbuffer_shrink_delay_ms > 0.0) {
+    delay_passed = (now - ctx->shrink_pending_since) * 1000.0 >= desc->backbuffer_shrink_delay_ms;
+  }
+
+  if (!delay_passed && sgg__fits_max_bytes(desc, grown)) {
+    return grown;
+  }
+
+  ctx->shrink_pending_frames = 0;
+  return target;
+}
+
+// Picks the backbuffer size for the window, and returns `true` if it has to be
+// reallocated. Doesn't call GLFW or the backend, so that the resize simulator can
+// run it too. `now` (in seconds) is only used with `backbuffer_shrink_delay_ms`.
+static bool sgg__next_backbuffer_size(sgg__context* ctx, sgg_size window, sgg_size render, double now, sgg_size* new_size) {
+  // The cached sizes are updated by the GLFW callbacks, so unless the window was
+  // resized (or a deferred downsize is pending), there's nothing to do.
+  if (!ctx->size_dirty && !ctx->shrink_pending_frames) {
+    return false;
+  }
+  ctx->size_dirty = false;
+
+  sgg_size curr_size = ctx->backbuffer_size;
+#ifdef SOKOL_METAL
+  // The layer stretches the whole drawable over the window, so when scaled, it
+  // has to match the render size exactly.
+  *new_size = ctx->desc.adaptive_resolution ? render : sgg__resolve_backbuffer_size(ctx, curr_size, window, now);
+#else
+  _SOKOL_UNUSED(render);
+  *new_size = sgg__resolve_backbuffer_size(ctx, curr_size, window, now);
+#endif
+
+  return new_size->width != curr_size.width || new_size->height != curr_size.height;
+}
+
+static void sgg__set_backbuffer_size(sgg__context* ctx, sgg_size size) {
+  ctx->backbuffer_size  = size;
+  ctx->backbuffer_bytes = sgg__backbuffer_bytes(&ctx->desc, size.width, size.height);
+  ctx->resize_count++;
+}
+
+static void sgg__init_scale_controller(sgg__context* ctx) {
+  const sgg_environment_desc* desc  = &ctx->desc;
+  sgg__scale_controller*      scale = &ctx->scale;
+
+  float min_scale = desc->adaptive_min_scale > 0.0f ? desc->adaptive_min_scale : 0.5f;
+  float max_scale = desc->adaptive_max_scale > 0.0f ? desc->adaptive_max_scale : 1.0f;
+
+  scale->min_steps    = sgg__max(1, (int)(min_scale * SGG__SCALE_STEPS + 0.999f));
+  scale->max_steps    = sgg__max(scale->min_steps, (int)(max_scale * SGG__SCALE_STEPS + 0.001f));
+  scale->steps        = scale->max_steps;
+  scale->hysteresis   = desc->adaptive_hysteresis > 0.0 ? desc->adaptive_hysteresis : 0.1;
+  scale->probe_frames = SGG__SCALE_PROBE_FRAMES;
+
+  scale->target_ms = desc->adaptive_target_ms;
+  if (scale->target_ms <= 0.0) {
+    GLFWmonitor*       monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* mode    = monitor ? glfwGetVideoMode(monitor) : NULL;
+    scale->target_ms           = 1000.0 / (mode && mode->refreshRate > 0 ? mode->refreshRate : 60);
+  }
+}
+
+static sgg_size sgg__render_size(const sgg__context* ctx, sgg_size window) {
+  if (!ctx->desc.adaptive_resolution) {
+    return window;
+  }
+
+  int steps = ctx->scale.steps;
+  return (sgg_size){
+    window.width ? sgg__max(1, (window.width * steps + SGG__SCALE_STEPS / 2) / SGG__SCALE_STEPS) : 0,
+    window.height ? sgg__max(1, (window.height * steps + SGG__SCALE_STEPS / 2) / SGG__SCALE_STEPS) : 0,
+  };
+}
+
+// The cost of a frame is assumed to be proportional to its pixel count, i.e., to
+// the square of the scale.
+static void sgg__update_render_scale(sgg__context* ctx, double frame_ms) {
+  sgg__scale_controller* scale = &ctx->scale;
+
+  scale->average_ms = scale->average_ms > 0.0 ? scale->average_ms + 0.1 * (frame_ms - scale->average_ms) : frame_ms;
+
+  // Let the average catch up with the last change first.
+  if (scale->cooldown_frames > 0) {
+    scale->cooldown_frames--;
+    return;
+  }
+
+  int    steps = scale->steps;
+  double ratio = scale->target_ms / scale->average_ms;
+
+  if (scale->average_ms > scale->target_ms * (1.0 + scale->hysteresis)) {
+    do {
+      steps--;
+    } while (steps > scale->min_steps && (double)steps * steps > ratio * scale->steps * scale->steps);
+
+    // A failed probe makes the next one wait longer.
+    if (scale->probing) {
+      scale->probe_frames = sgg__min(scale->probe_frames * 2, SGG__SCALE_MAX_PROBE_FRAMES);
+    }
+    scale->probing = false;
+  } else if (scale->average_ms < scale->target_ms * (1.0 - scale->hysteresis)) {
+    do {
+      steps++;
+    } while (steps < scale->max_steps && (double)(steps + 1) * (steps + 1) <= ratio * scale->steps * scale->steps);
+
+    scale->probing = false;
+  } else if (steps < scale->max_steps && ++scale->stable_frames >= scale->probe_frames) {
+    // Within the band, the frame time doesn't tell how much headroom there is
+    // (e.g., with vsync), so try one step up.
+    if (scale->probing) {
+      scale->probe_frames = SGG__SCALE_PROBE_FRAMES;
+    }
+    scale->probing = true;
+    steps++;
+  }
+
+  steps = sgg__max(scale->min_steps, sgg__min(steps, scale->max_steps));
+  if (steps != scale->steps) {
+    scale->steps           = steps;
+    scale->cooldown_frames = SGG__SCALE_COOLDOWN_FRAMES;
+    scale->stable_frames   = 0;
+    ctx->size_dirty        = true;
+  }
+}
+
+// Context IDs hold the slot index plus one in the lower bits, and the slot's
+// generation, bumped on each reuse, in the upper ones. Like the sokol_gfx
+// resource handles, stale IDs then don't alias the slot's next context.
+#define SGG__CONTEXT_SLOT_BITS 16
+#define SGG__CONTEXT_SLOT_MASK ((1u << SGG__CONTEXT_SLOT_BITS) - 1)
+
+static uint32_t sgg__next_context_id(int slot) {
+  uint32_t generation = ++g_sgg_context_generations[slot] & (UINT32_MAX >> SGG__CONTEXT_SLOT_BITS);
+  if (generation == 0) {
+    generation = ++g_sgg_context_generations[slot] & (UINT32_MAX >> SGG__CONTEXT_SLOT_BITS);
+  }
+  return (generation << SGG__CONTEXT_SLOT_BITS) | (uint32_t)(slot + 1);
+}
+
+static sgg__context* sgg__lookup_context(uint32_t id) {
+  uint32_t slot = id & SGG__CONTEXT_SLOT_MASK;
+  if (!g_sgg_state.valid || slot == 0 || slot > SGG_MAX_CONTEXTS) {
+    return NULL;
+  }
+
+  sgg__context* ctx = &g_sgg_state.contexts[slot - 1];
+  return ctx->desc.window && ctx->id == id ? ctx : NULL;
+}
+
+static sgg__context* sgg__current_context(void) {
+  return sgg__lookup_context(g_sgg_state.current_context_id);
+}
+
+static void sgg__validate_desc(const sgg_environment_desc* desc) {
+  SOKOL_ASSERT(desc);
+  SOKOL_ASSERT(desc->window);
+  SOKOL_ASSERT(desc->backbuffer_min_width >= 0);
+  SOKOL_ASSERT(desc->backbuffer_min_height >= 0);
+  SOKOL_ASSERT(desc->sample_count >= 0);
+  SOKOL_ASSERT(desc->swapchain_buffer_count == 0 || desc->swapchain_buffer_count == 2 || desc->swapchain_buffer_count == 3);
+  SOKOL_ASSERT(desc->max_frames_in_flight >= 0 && desc->max_frames_in_flight <= SGG__MAX_FRAMES_IN_FLIGHT);
+  SOKOL_ASSERT(desc->resize_policy != SGG_RESIZE_POLICY_CUSTOM || desc->resize_func);
+  SOKOL_ASSERT(desc->backbuffer_shrink_delay_frames >= 0);
+  SOKOL_ASSERT(desc->backbuffer_shrink_delay_ms >= 0.0);
+  SOKOL_ASSERT(desc->adaptive_target_ms >= 0.0);
+  SOKOL_ASSERT(desc->adaptive_hysteresis >= 0.0 && desc->adaptive_hysteresis < 1.0);
+  SOKOL_ASSERT(desc->adaptive_min_scale >= 0.0f && desc->adaptive_min_scale <= 1.0f);
+  SOKOL_ASSERT(desc->adaptive_max_scale >= 0.0f && desc->adaptive_max_scale <= 1.0f);
+  SOKOL_ASSERT(desc->present_mode >= SGG_PRESENT_MODE_FIFO && desc->present_mode <= SGG_PRESENT_MODE_IMMEDIATE);
+  SOKOL_ASSERT(desc->frame_deadline_margin_ms >= 0.0);
+#if defined(SOKOL_D3D11) || defined(SOKOL_METAL) || (defined(SOKOL_GLCORE) && defined(_WIN32))
+  SOKOL_ASSERT(!desc->headless && "headless mode is only supported with EGL and the dummy backend");
+#endif
+  _SOKOL_UNUSED(desc);
+}
+
+static sgg__context* sgg__find_context(GLFWwindow* window) {
+  for (int i = 0; i < SGG_MAX_CONTEXTS; i++) {
+    if (g_sgg_state.contexts[i].desc.window == window) {
+      return &g_sgg_state.contexts[i];
+    }
+  }
+  return NULL;
+}
+
+static void sgg__record_window_event(sgg__context* ctx, sgg_window_event event) {
+  if (ctx->recorded_count < ctx->recorded_capacity) {
+    event.time_ms                               = (glfwGetTime() - ctx->recording_start) * 1000.0;
+    ctx->recorded_events[ctx->recorded_count++] = event;
+  }
+}
+
+static void sgg__apply_event(sgg__context* ctx, const sgg__event* event) {
+  switch (event->type) {
+  case SGG__EVENT_FRAMEBUFFER_SIZE:
+    ctx->framebuffer_width  = event->width;
+    ctx->framebuffer_height = event->height;
+    break;
+  case SGG__EVENT_CONTENT_SCALE:
+    ctx->content_scale_x = event->x_scale;
+    ctx->content_scale_y = event->y_scale;
+    break;
+  case SGG__EVENT_MONITOR_SIZE:
+    ctx->monitor_size = (sgg_size){event->width, event->height};
+    break;
+  }
+  ctx->size_dirty = true;
+
+  if (ctx->recorded_events) {
+    static const sgg_window_event_type types[] = {
+      SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE,
+      SGG_WINDOW_EVENT_CONTENT_SCALE,
+      SGG_WINDOW_EVENT_MONITOR_SIZE,
+    };
+    sgg__record_window_event(ctx, (sgg_window_event){
+      .type    = types[event->type],
+      .width   = event->width,
+      .height  = event->height,
+      .x_scale = event->x_scale,
+      .y_scale = event->y_scale,
+    });
+  }
+}
+
+static uint32_t sgg__float_bits(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static float sgg__bits_float(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+#define SGG__OVERFLOW_VALID (1ull << 63)
+
+// Called on the main thread.
+static void sgg__push_event(sgg__context* ctx, const sgg__event* event) {
+  sgg__event_queue* queue = &ctx->events;
+
+  uint32_t head = queue->head; // Only written by this thread.
+  uint32_t tail = sgg__atomic_load_u32(&queue->tail);
+
+  if (head - tail < SGG_EVENT_QUEUE_SIZE) {
+    queue->events[head % SGG_EVENT_QUEUE_SIZE] = *event;
+    sgg__atomic_store_u32(&queue->head, head + 1);
+    return;
+  }
+
+  // Scales are positive, so their sign bit is free for the valid flag.
+  if (event->type == SGG__EVENT_FRAMEBUFFER_SIZE || event->type == SGG__EVENT_MONITOR_SIZE) {
+    uint64_t packed = SGG__OVERFLOW_VALID | ((uint64_t)(uint32_t)event->width << 31) | (uint32_t)event->height;
+    sgg__atomic_exchange_u64(event->type == SGG__EVENT_FRAMEBUFFER_SIZE ? &queue->overflow_size : &queue->overflow_monitor_size, packed);
+  } else {
+    uint64_t packed = SGG__OVERFLOW_VALID | ((uint64_t)sgg__float_bits(event->x_scale) << 32) | sgg__float_bits(event->y_scale);
+    sgg__atomic_exchange_u64(&queue->overflow_scale, packed);
+  }
+}
+
+// Called on the render thread.
+static void sgg__drain_events(sgg__context* ctx) {
+  sgg__event_queue* queue = &ctx->events;
+
+  uint32_t tail = queue->tail; // Only written by this thread.
+  uint32_t head = sgg__atomic_load_u32(&queue->head);
+
+  for (; tail != head; tail++) {
+    sgg__apply_event(ctx, &queue->events[tail % SGG_EVENT_QUEUE_SIZE]);
+  }
+  sgg__atomic_store_u32(&queue->tail, tail);
+
+  uint64_t packed = sgg__atomic_exchange_u64(&queue->overflow_size, 0);
+  if (packed & SGG__OVERFLOW_VALID) {
+    sgg__event event = {
+      .type   = SGG__EVENT_FRAMEBUFFER_SIZE,
+      .width  = (int)((packed >> 31) & 0x7fffffff),
+      .height = (int)(packed & 0x7fffffff),
+    };
+    sgg__apply_event(ctx, &event);
+  }
+
+  packed = sgg__atomic_exchange_u64(&queue->overflow_monitor_size, 0);
+  if (packed & SGG__OVERFLOW_VALID) {
+    sgg__event event = {
+      .type   = SGG__EVENT_MONITOR_SIZE,
+      .width  = (int)((packed >> 31) & 0x7fffffff),
+      .height = (int)(packed & 0x7fffffff),
+    };
+    sgg__apply_event(ctx, &event);
+  }
+
+  packed = sgg__atomic_exchange_u64(&queue->overflow_scale, 0);
+  if (packed & SGG__OVERFLOW_VALID) {
+    sgg__event event = {
+      .type    = SGG__EVENT_CONTENT_SCALE,
+      .x_scale = sgg__bits_float((uint32_t)(packed >> 32) & 0x7fffffff),
+      .y_scale = sgg__bits_float((uint32_t)packed),
+    };
+    sgg__apply_event(ctx, &event);
+  }
+}
+
+static void sgg__handle_event(sgg__context* ctx, const sgg__event* event) {
+  sgg__atomic_store_u32(&ctx->invalidated, 1);
+
+  if (g_sgg_state.render_thread) {
+    sgg__push_event(ctx, event);
+  } else {
+    sgg__apply_event(ctx, event);
+  }
+}
+
+// Returns the monitor of a full screen window, or the one a windowed window
+// overlaps the most.
+static GLFWmonitor* sgg__window_monitor(GLFWwindow* window) {
+  GLFWmonitor* monitor = glfwGetWindowMonitor(window);
+  if (monitor) {
+    return monitor;
+  }
+
+  int x, y, width, height;
+  glfwGetWindowPos(window, &x, &y);
+  glfwGetWindowSize(window, &width, &height);
+
+  int           count        = 0;
+  GLFWmonitor** monitors     = glfwGetMonitors(&count);
+  long long     best_overlap = 0;
+
+  for (int i = 0; i < count; i++) {
+    const GLFWvidmode* mode = glfwGetVideoMode(monitors[i]);
+    if (!mode) {
+      continue;
+    }
+
+    int monitor_x, monitor_y;
+    glfwGetMonitorPos(monitors[i], &monitor_x, &monitor_y);
+
+    int       overlap_width  = sgg__min(x + width, monitor_x + mode->width) - sgg__max(x, monitor_x);
+    int       overlap_height = sgg__min(y + height, monitor_y + mode->height) - sgg__max(y, monitor_y);
+    long long overlap        = overlap_width > 0 && overlap_height > 0 ? (long long)overlap_width * overlap_height : 0;
+    if (overlap > best_overlap) {
+      best_overlap = overlap;
+      monitor      = monitors[i];
+    }
+  }
+
+  return monitor ? monitor : glfwGetPrimaryMonitor();
+}
+
+// Picks up the refresh rate and, with `backbuffer_fit_monitor`, the largest
+// framebuffer size of the window's monitor. Main thread only, like all GLFW
+// monitor functions, so both are handed over to the render thread (through an
+// atomic, and the event queue).
+static void sgg__update_monitor(sgg__context* ctx) {
+  GLFWwindow*        window  = ctx->desc.window;
+  GLFWmonitor*       monitor = sgg__window_monitor(window);
+  const GLFWvidmode* mode    = monitor ? glfwGetVideoMode(monitor) : NULL;
+  sgg__atomic_store_u32(&ctx->refresh_rate, mode && mode->refreshRate > 0 ? (uint32_t)mode->refreshRate : 0u);
+
+  if (!ctx->desc.backbuffer_fit_monitor || !mode) {
+    return;
+  }
+
+  // The video mode is in screen coordinates, which aren't pixels everywhere
+  // (e.g., on macOS), so it's converted with the window's own ratio.
+  int width, height, framebuffer_width, framebuffer_height;
+  glfwGetWindowSize(window, &width, &height);
+  glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+  if (width <= 0 || height <= 0 || framebuffer_width <= 0 || framebuffer_height <= 0) {
+    return; // Minimized, keep the last plan.
+  }
+
+  sgg_size size = {
+    (int)(((long long)mode->width * framebuffer_width + width - 1) / width),
+    (int)(((long long)mode->height * framebuffer_height + height - 1) / height),
+  };
+  if (size.width == ctx->planned_monitor_size.width && size.height == ctx->planned_monitor_size.height) {
+    return;
+  }
+  ctx->planned_monitor_size = size;
+
+  sgg__event event = {
+    .type   = SGG__EVENT_MONITOR_SIZE,
+    .width  = size.width,
+    .height = size.height,
+  };
+  sgg__handle_event(ctx, &event);
+}
+
+
+static void sgg__framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+  sgg__context* ctx = sgg__find_context(window);
+  if (!ctx) {
+    return;
+  }
+
+  sgg__event event = {
+    .type   = SGG__EVENT_FRAMEBUFFER_SIZE,
+    .width  = width,
+    .height = height,
+  };
+  sgg__handle_event(ctx, &event);
+
+  if (ctx->prev_framebuffer_size_callback) {
+    ctx->prev_framebuffer_size_callback(window, width, height);
+  }
+}
+
+static void sgg__content_scale_callback(GLFWwindow* window, float x_scale, float y_scale) {
+  sgg__context* ctx = sgg__find_context(window);
+  if (!ctx) {
+    return;
+  }
+
+  sgg__event event = {
+    .type    = SGG__EVENT_CONTENT_SCALE,
+    .x_scale = x_scale,
+    .y_scale = y_scale,
+  };
+  sgg__handle_event(ctx, &event);
+
+  // Moving to a monitor with another scale also changes the pixel ratio.
+  sgg__update_monitor(ctx);
+
+  if (ctx->prev_content_scale_callback) {
+    ctx->prev_content_scale_callback(window, x_scale, y_scale);
+  }
+}
+
+static void sgg__iconify_callback(GLFWwindow* window, int iconified) {
+  sgg__context* ctx = sgg__find_context(window);
+  if (!ctx) {
+    return;
+  }
+
+  sgg__atomic_store_u32(&ctx->iconified, iconified ? 1 : 0);
+  sgg__atomic_store_u32(&ctx->invalidated, 1);
+
+  if (ctx->prev_iconify_callback) {
+    ctx->prev_iconify_callback(window, iconified);
+  }
+}
+
+static void sgg__pos_callback(GLFWwindow* window, int x, int y) {
+  sgg__context* ctx = sgg__find_context(window);
+  if (!ctx) {
+    return;
+  }
+
+  sgg__update_monitor(ctx);
+
+  if (ctx->prev_pos_callback) {
+    ctx->prev_pos_callback(window, x, y);
+  }
+}
+
+// The windows can end up on another monitor when theirs is disconnected, and
+// the overlaps change when one is connected.
+static void sgg__monitor_callback(GLFWmonitor* monitor, int event) {
+  for (int i = 0; i < SGG_MAX_CONTEXTS; i++) {
+    if (g_sgg_state.contexts[i].desc.window) {
+      sgg__update_monitor(&g_sgg_state.contexts[i]);
+    }
+  }
+
+  if (g_sgg_state.prev_monitor_callback) {
+    g_sgg_state.prev_monitor_callback(monitor, event);
+  }
+}
+
+// The remaining callbacks only mark the window as needing a new frame.
+
+static sgg__context* sgg__invalidate_window(GLFWwindow* window) {
+  sgg__context* ctx = sgg__find_context(window);
+  if (ctx) {
+    sgg__atomic_store_u32(&ctx->invalidated, 1);
+  }
+  return ctx;
+}
+
+static void sgg__refresh_callback(GLFWwindow* window) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_refresh_callback) {
+    ctx->prev_refresh_callback(window);
+  }
+}
+
+static void sgg__focus_callback(GLFWwindow* window, int focused) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_focus_callback) {
+    ctx->prev_focus_callback(window, focused);
+  }
+}
+
+static void sgg__key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_key_callback) {
+    ctx->prev_key_callback(window, key, scancode, action, mods);
+  }
+}
+
+static void sgg__char_callback(GLFWwindow* window, unsigned int codepoint) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_char_callback) {
+    ctx->prev_char_callback(window, codepoint);
+  }
+}
+
+static void sgg__mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_mouse_button_callback) {
+    ctx->prev_mouse_button_callback(window, button, action, mods);
+  }
+}
+
+static void sgg__cursor_pos_callback(GLFWwindow* window, double x, double y) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_cursor_pos_callback) {
+    ctx->prev_cursor_pos_callback(window, x, y);
+  }
+}
+
+static void sgg__cursor_enter_callback(GLFWwindow* window, int entered) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_cursor_enter_callback) {
+    ctx->prev_cursor_enter_callback(window, entered);
+  }
+}
+
+static void sgg__scroll_callback(GLFWwindow* window, double x_offset, double y_offset) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_scroll_callback) {
+    ctx->prev_scroll_callback(window, x_offset, y_offset);
+  }
+}
+
+static void sgg__drop_callback(GLFWwindow* window, int path_count, const char** paths) {
+  sgg__context* ctx = sgg__invalidate_window(window);
+  if (ctx && ctx->prev_drop_callback) {
+    ctx->prev_drop_callback(window, path_count, paths);
+  }
+}
+
+// Grows the ring of staging buffers to `count`. The readbacks keep their order,
+// so the ones in flight or mapped are still returned and unmapped as before.
+static void sgg__reserve_readbacks(sgg__context* ctx, uint32_t count) {
+  if (count <= ctx->readback_count) {
+    return;
+  }
+
+  sgg__readback* readbacks = (sgg__readback*)calloc(count, sizeof(sgg__readback));
+  SOKOL_ASSERT(readbacks);
+  for (uint32_t i = 0; i < ctx->readback_count; i++) {
+    uint32_t index                              = ctx->readback_tail + i;
+    readbacks[index % count]                    = ctx->readbacks[index % ctx->readback_count];
+    ctx->readbacks[index % ctx->readback_count] = (sgg__readback){0};
+  }
+
+  free(ctx->readbacks);
+  ctx->readbacks      = readbacks;
+  ctx->readback_count = count;
+}
+
+// Destroys the staging buffers, dropping the readbacks left in flight. They're
+// allocated again by the next request.
+static void sgg__release_readbacks(sgg__context* ctx) {
+  SOKOL_ASSERT(!ctx->readback_mapped);
+  for (uint32_t i = 0; i < ctx->readback_count; i++) {
+    sgg__platform_destroy_readback(&g_sgg_state, ctx, &ctx->readbacks[i]);
+  }
+
+  free(ctx->readbacks);
+  ctx->readbacks          = NULL;
+  ctx->readback_count     = 0;
+  ctx->readback_tail      = ctx->readback_head;
+  ctx->readback_requested = false;
+}
+
+// The copy is only recorded (before the backbuffer is gone in the present), it's
+// waited for in `sgg_poll_readback`.
+static void sgg__copy_readback(sgg__context* ctx) {
+  sgg__readback* readback = &ctx->readbacks[ctx->readback_head % ctx->readback_count];
+
+  // The backbuffer can be larger than the rendered area, but never smaller.
+  readback->width       = sgg__min(ctx->swapchain_size.width, ctx->backbuffer_size.width);
+  readback->height      = sgg__min(ctx->swapchain_size.height, ctx->backbuffer_size.height);
+  readback->frame_index = ctx->frame_index;
+
+  if (readback->width > 0 && readback->height > 0 && sgg__platform_copy_readback(&g_sgg_state, ctx, readback)) {
+    ctx->readback_head++;
+    ctx->readback_requested = false;
+  }
+}
+
+static bool sgg__request_readback(sgg__context* ctx) {
+  if (!ctx->readback_requested) {
+    sgg__reserve_readbacks(ctx, SGG_READBACK_COUNT);
+    if (ctx->readback_head - ctx->readback_tail >= ctx->readback_count) {
+      return false;
+    }
+    ctx->readback_requested = true;
+  }
+
+  return true;
+}
+
+// The readbacks between `readback_tail` and `readback_tail + readback_mapped`
+// are mapped, and they're unmapped in the same order.
+
+static bool sgg__map_readback(sgg__context* ctx, sgg_readback* readback) {
+  uint32_t index = ctx->readback_tail + ctx->readback_mapped;
+  if (index == ctx->readback_head) {
+    return false;
+  }
+
+  sgg__readback* oldest = &ctx->readbacks[index % ctx->readback_count];
+
+  *readback = (sgg_readback){
+    .width       = oldest->width,
+    .height      = oldest->height,
+    .frame_index = oldest->frame_index,
+  };
+  if (!sgg__platform_map_readback(&g_sgg_state, ctx, oldest, readback)) {
+    return false;
+  }
+
+  ctx->readback_mapped++;
+  return true;
+}
+
+static void sgg__unmap_readback(sgg__context* ctx) {
+  SOKOL_ASSERT(ctx->readback_mapped);
+  sgg__platform_unmap_readback(&g_sgg_state, ctx, &ctx->readbacks[ctx->readback_tail % ctx->readback_count]);
+  ctx->readback_mapped--;
+  ctx->readback_tail++;
+}
+
+static bool sgg__poll_readback(sgg__context* ctx, sgg_readback* readback) {
+  // The previously returned pixels aren't needed anymore.
+  while (ctx->readback_mapped) {
+    sgg__unmap_readback(ctx);
+  }
+
+  return sgg__map_readback(ctx, readback);
+}
+
+static void sgg__init_context(sgg__context* ctx, const sgg_environment_desc* desc) {
+  *ctx              = (sgg__context){0};
+  ctx->id           = sgg__next_context_id((int)(ctx - g_sgg_state.contexts));
+  ctx->desc         = *desc;
+  ctx->present_mode = sgg__platform_present_mode(&g_sgg_state, desc->present_mode);
+  ctx->size_dirty   = true;
+
+  if (desc->adaptive_resolution) {
+    sgg__init_scale_controller(ctx);
+  }
+
+  glfwGetFramebufferSize(desc->window, &ctx->framebuffer_width, &ctx->framebuffer_height);
+  glfwGetWindowContentScale(desc->window, &ctx->content_scale_x, &ctx->content_scale_y);
+
+  ctx->invalidated = 1;
+  ctx->iconified   = glfwGetWindowAttrib(desc->window, GLFW_ICONIFIED) ? 1 : 0;
+  sgg__update_monitor(ctx);
+
+  ctx->prev_framebuffer_size_callback = glfwSetFramebufferSizeCallback(desc->window, sgg__framebuffer_size_callback);
+  ctx->prev_content_scale_callback    = glfwSetWindowContentScaleCallback(desc->window, sgg__content_scale_callback);
+  ctx->prev_refresh_callback          = glfwSetWindowRefreshCallback(desc->window, sgg__refresh_callback);
+  ctx->prev_iconify_callback          = glfwSetWindowIconifyCallback(desc->window, sgg__iconify_callback);
+  ctx->prev_pos_callback              = glfwSetWindowPosCallback(desc->window, sgg__pos_callback);
+
+  if (desc->redraw_on_input) {
+    ctx->prev_focus_callback        = glfwSetWindowFocusCallback(desc->window, sgg__focus_callback);
+    ctx->prev_key_callback          = glfwSetKeyCallback(desc->window, sgg__key_callback);
+    ctx->prev_char_callback         = glfwSetCharCallback(desc->window, sgg__char_callback);
+    ctx->prev_mouse_button_callback = glfwSetMouseButtonCallback(desc->window, sgg__mouse_button_callback);
+    ctx->prev_cursor_pos_callback   = glfwSetCursorPosCallback(desc->window, sgg__cursor_pos_callback);
+    ctx->prev_cursor_enter_callback = glfwSetCursorEnterCallback(desc->window, sgg__cursor_enter_callback);
+    ctx->prev_scroll_callback       = glfwSetScrollCallback(desc->window, sgg__scroll_callback);
+    ctx->prev_drop_callback         = glfwSetDropCallback(desc->window, sgg__drop_callback);
+  }
+
+  sgg__platform_init_context(&g_sgg_state, ctx);
+}
+
+#define SGG__RESTORE_CALLBACK(set_callback, window, prev_callback, callback) \
+  do {                                                                       \
+    if (set_callback((window), (prev_callback)) != (callback)) {             \
+      set_callback((window), NULL);                                          \
+    }                                                                        \
+  } while (0)
+
+static void sgg__shutdown_context(sgg__context* ctx) {
+  while (ctx->readback_mapped) {
+    sgg__unmap_readback(ctx);
+  }
+  sgg__release_readbacks(ctx);
+
+  sgg__platform_shutdown_context(&g_sgg_state, ctx);
+
+  // Put the previous callbacks back, unless they've been replaced since.
+  GLFWwindow* window = ctx->desc.window;
+  SGG__RESTORE_CALLBACK(glfwSetFramebufferSizeCallback, window, ctx->prev_framebuffer_size_callback, sgg__framebuffer_size_callback);
+  SGG__RESTORE_CALLBACK(glfwSetWindowContentScaleCallback, window, ctx->prev_content_scale_callback, sgg__content_scale_callback);
+  SGG__RESTORE_CALLBACK(glfwSetWindowRefreshCallback, window, ctx->prev_refresh_callback, sgg__refresh_callback);
+  SGG__RESTORE_CALLBACK(glfwSetWindowIconifyCallback, window, ctx->prev_iconify_callback, sgg__iconify_callback);
+  SGG__RESTORE_CALLBACK(glfwSetWindowPosCallback, window, ctx->prev_pos_callback, sgg__pos_callback);
+
+  if (ctx->desc.redraw_on_input) {
+    SGG__RESTORE_CALLBACK(glfwSetWindowFocusCallback, window, ctx->prev_focus_callback, sgg__focus_callback);
+    SGG__RESTORE_CALLBACK(glfwSetKeyCallback, window, ctx->prev_key_callback, sgg__key_callback);
+    SGG__RESTORE_CALLBACK(glfwSetCharCallback, window, ctx->prev_char_callback, sgg__char_callback);
+    SGG__RESTORE_CALLBACK(glfwSetMouseButtonCallback, window, ctx->prev_mouse_button_callback, sgg__mouse_button_callback);
+    SGG__RESTORE_CALLBACK(glfwSetCursorPosCallback, window, ctx->prev_cursor_pos_callback, sgg__cursor_pos_callback);
+    SGG__RESTORE_CALLBACK(glfwSetCursorEnterCallback, window, ctx->prev_cursor_enter_callback, sgg__cursor_enter_callback);
+    SGG__RESTORE_CALLBACK(glfwSetScrollCallback, window, ctx->prev_scroll_callback, sgg__scroll_callback);
+    SGG__RESTORE_CALLBACK(glfwSetDropCallback, window, ctx->prev_drop_callback, sgg__drop_callback);
+  }
+
+  *ctx = (sgg__context){0};
+}
+
+#ifdef SGG_ENABLE_CAPTURE
+#  if defined(_WIN32)
+static void sgg__mutex_init(sgg__mutex* mutex) {
+  InitializeCriticalSection(mutex);
+}
+
+static void sgg__mutex_destroy(sgg__mutex* mutex) {
+  DeleteCriticalSection(mutex);
+}
+
+static void sgg__mutex_lock(sgg__mutex* mutex) {
+  EnterCriticalSection(mutex);
+}
+
+static void sgg__mutex_unlock(sgg__mutex* mutex) {
+  LeaveCriticalSection(mutex);
+}
+
+static void sgg__cond_init(sgg__cond* cond) {
+  InitializeConditionVariable(cond);
+}
+
+static void sgg__cond_destroy(sgg__cond* cond) {
+  _SOKOL_UNUSED(cond);
+}
+
+static void sgg__cond_wait(sgg__cond* cond, sgg__mutex* mutex) {
+  SleepConditionVariableCS(cond, mutex, INFINITE);
+}
+
+static void sgg__cond_signal(sgg__cond* cond) {
+  WakeConditionVariable(cond);
+}
+
+typedef struct {
+  void (*func)(void*);
+  void* arg;
+} sgg__thread_start;
+
+static DWORD WINAPI sgg__thread_proc(LPVOID param) {
+  sgg__thread_start start = *(sgg__thread_start*)param;
+  free(param);
+  start.func(start.arg);
+  return 0;
+}
+
+static void sgg__thread_create(sgg__thread* thread, void (*func)(void*), void* arg) {
+  sgg__thread_start* start = (sgg__thread_start*)malloc(sizeof(sgg__thread_start));
+  SOKOL_ASSERT(start);
+  start->func = func;
+  start->arg  = arg;
+
+  *thread = CreateThread(NULL, 0, sgg__thread_proc, start, 0, NULL);
+  SOKOL_ASSERT(*thread);
+}
+
+static void sgg__thread_join(sgg__thread thread) {
+  WaitForSingleObject(thread, INFINITE);
+  CloseHandle(thread);
+}
+#  else
+static void sgg__mutex_init(sgg__mutex* mutex) {
+  pthread_mutex_init(mutex, NULL);
+}
+
+static void sgg__mutex_destroy(sgg__mutex* mutex) {
+  pthread_mutex_destroy(mutex);
+}
+
+static void sgg__mutex_lock(sgg__mutex* mutex) {
+  pthread_mutex_lock(mutex);
+}
+
+static void sgg__mutex_unlock(sgg__mutex* mutex) {
+  pthread_mutex_unlock(mutex);
+}
+
+static void sgg__cond_init(sgg__cond* cond) {
+  pthread_cond_init(cond, NULL);
+}
+
+static void sgg__cond_destroy(sgg__cond* cond) {
+  pthread_cond_destroy(cond);
+}
+
+static void sgg__cond_wait(sgg__cond* cond, sgg__mutex* mutex) {
+  pthread_cond_wait(cond, mutex);
+}
+
+static void sgg__cond_signal(sgg__cond* cond) {
+  pthread_cond_signal(cond);
+}
+
+typedef struct {
+  void (*func)(void*);
+  void* arg;
+} sgg__thread_start;
+
+static void* sgg__thread_proc(void* param) {
+  sgg__thread_start start = *(sgg__thread_start*)param;
+  free(param);
+  start.func(start.arg);
+  return NULL;
+}
+
+static void sgg__thread_create(sgg__thread* thread, void (*func)(void*), void* arg) {
+  sgg__thread_start* start = (sgg__thread_start*)malloc(sizeof(sgg__thread_start));
+  SOKOL_ASSERT(start);
+  start->func = func;
+  start->arg  = arg;
+
+  int result = pthread_create(thread, NULL, sgg__thread_proc, start);
+  SOKOL_ASSERT(result == 0);
+  _SOKOL_UNUSED(result);
+}
+
+static void sgg__thread_join(sgg__thread thread) {
+  pthread_join(thread, NULL);
+}
+#  endif // _WIN32
+
+// BT.601 limited range, with the coefficients scaled so that the SIMD kernels
+// can use 8-bit multiplies (`(13, 64, 33) / 128` for Y, `(112, 74, 38) / 256`
+// and `(112, 94, 18) / 256` for U and V). Chroma is the average of 2x2 pixels,
+// averaged vertically first, as `_mm_avg_epu8` / `vrhaddq_u8` do, so that all
+// kernels produce identical results.
+
+static uint8_t sgg__avg_u8(int a, int b) {
+  return (uint8_t)((a + b + 1) >> 1);
+}
+
+static void sgg__rgba_row_scalar(const uint8_t* src, uint8_t* dst, int width) {
+  for (int x = 0; x < width; x++, src += 4, dst += 4) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+    dst[3] = src[3];
+  }
+}
+
+static void sgg__y_row_scalar(const uint8_t* src, uint8_t* dst, int width) {
+  for (int x = 0; x < width; x++, src += 4) {
+    dst[x] = (uint8_t)(((13 * src[0] + 64 * src[1] + 33 * src[2] + 64) >> 7) + 16);
+  }
+}
+
+static void sgg__uv_row_scalar(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width) {
+  for (int x = 0; x < width; x += 2) {
+    // The last column is repeated for odd widths.
+    int next = x + 1 < width ? 4 : 0;
+
+    int bgr[3];
+    for (int c = 0; c < 3; c++) {
+      bgr[c] = sgg__avg_u8(sgg__avg_u8(src0[c], src1[c]), sgg__avg_u8(src0[c + next], src1[c + next]));
+    }
+
+    // The sums are within [-28560, 28560], so the bias makes them positive.
+    u[x / 2] = (uint8_t)((112 * bgr[0] - 74 * bgr[1] - 38 * bgr[2] + 0x8080) >> 8);
+    v[x / 2] = (uint8_t)((112 * bgr[2] - 94 * bgr[1] - 18 * bgr[0] + 0x8080) >> 8);
+
+    src0 += 8;
+    src1 += 8;
+  }
+}
+
+#  ifdef SGG__X86
+#    if defined(__GNUC__) || defined(__clang__)
+#      define SGG__TARGET(isa) __attribute__((target(isa)))
+#    else
+#      define SGG__TARGET(isa)
+#    endif
+
+static bool sgg__cpu_has_ssse3(void) {
+#    ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 9)) != 0;
+#    else
+  return __builtin_cpu_supports("ssse3");
+#    endif
+}
+
+static bool sgg__cpu_has_avx2(void) {
+#    ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+  __cpuidex(info, 7, 0);
+  return os_saves_ymm && (info[1] & (1 << 5));
+#    else
+  return __builtin_cpu_supports("avx2");
+#    endif
+}
+
+SGG__TARGET("ssse3")
+static void sgg__rgba_row_ssse3(const uint8_t* src, uint8_t* dst, int width) {
+  const __m128i swizzle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  int x = 0;
+  for (; x + 4 <= width; x += 4) {
+    __m128i pixels = _mm_loadu_si128((const __m128i*)(src + x * 4));
+    _mm_storeu_si128((__m128i*)(dst + x * 4), _mm_shuffle_epi8(pixels, swizzle));
+  }
+  sgg__rgba_row_scalar(src + x * 4, dst + x * 4, width - x);
+}
+
+SGG__TARGET("ssse3")
+static void sgg__y_row_ssse3(const uint8_t* src, uint8_t* dst, int width) {
+  const __m128i coeffs = _mm_setr_epi8(13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0);
+  const __m128i round  = _mm_set1_epi16(64);
+  const __m128i offset = _mm_set1_epi8(16);
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const __m128i* pixels = (const __m128i*)(src + x * 4);
+
+    __m128i p0 = _mm_maddubs_epi16(_mm_loadu_si128(pixels + 0), coeffs);
+    __m128i p1 = _mm_maddubs_epi16(_mm_loadu_si128(pixels + 1), coeffs);
+    __m128i p2 = _mm_maddubs_epi16(_mm_loadu_si128(pixels + 2), coeffs);
+    __m128i p3 = _mm_maddubs_epi16(_mm_loadu_si128(pixels + 3), coeffs);
+
+    __m128i y0 = _mm_srli_epi16(_mm_add_epi16(_mm_hadd_epi16(p0, p1), round), 7);
+    __m128i y1 = _mm_srli_epi16(_mm_add_epi16(_mm_hadd_epi16(p2, p3), round), 7);
+
+    _mm_storeu_si128((__m128i*)(dst + x), _mm_add_epi8(_mm_packus_epi16(y0, y1), offset));
+  }
+  sgg__y_row_scalar(src + x * 4, dst + x, width - x);
+}
+
+// Averages the pixel pairs of two rows of 8 pixels each into 4 pixels.
+SGG__TARGET("ssse3")
+static __m128i sgg__avg_2x2_ssse3(const uint8_t* src0, const uint8_t* src1) {
+  __m128i a = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)src0), _mm_loadu_si128((const __m128i*)src1));
+  __m128i b = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)src0 + 1), _mm_loadu_si128((const __m128i*)src1 + 1));
+
+  __m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), 0x88));
+  __m128i odd  = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), 0xdd));
+
+  return _mm_avg_epu8(even, odd);
+}
+
+SGG__TARGET("ssse3")
+static void sgg__uv_row_ssse3(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width) {
+  const __m128i u_coeffs = _mm_setr_epi8(112, -74, -38, 0, 112, -74, -38, 0, 112, -74, -38, 0, 112, -74, -38, 0);
+  const __m128i v_coeffs = _mm_setr_epi8(-18, -94, 112, 0, -18, -94, 112, 0, -18, -94, 112, 0, -18, -94, 112, 0);
+  const __m128i bias     = _mm_set1_epi16((short)0x8080);
+
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    __m128i p0 = sgg__avg_2x2_ssse3(src0 + x * 4, src1 + x * 4);
+    __m128i p1 = sgg__avg_2x2_ssse3(src0 + x * 4 + 32, src1 + x * 4 + 32);
+
+    __m128i u16 = _mm_hadd_epi16(_mm_maddubs_epi16(p0, u_coeffs), _mm_maddubs_epi16(p1, u_coeffs));
+    __m128i v16 = _mm_hadd_epi16(_mm_maddubs_epi16(p0, v_coeffs), _mm_maddubs_epi16(p1, v_coeffs));
+
+    u16 = _mm_srli_epi16(_mm_add_epi16(u16, bias), 8);
+    v16 = _mm_srli_epi16(_mm_add_epi16(v16, bias), 8);
+
+    __m128i uv = _mm_packus_epi16(u16, v16);
+    _mm_storel_epi64((__m128i*)(u + x / 2), uv);
+    _mm_storel_epi64((__m128i*)(v + x / 2), _mm_srli_si128(uv, 8));
+  }
+  sgg__uv_row_scalar(src0 + x * 4, src1 + x * 4, u + x / 2, v + x / 2, width - x);
+}
+
+SGG__TARGET("avx2")
+static void sgg__rgba_row_avx2(const uint8_t* src, uint8_t* dst, int width) {
+  const __m256i swizzle = _mm256_setr_epi8(
+    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+    2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+  int x = 0;
+  for (; x + 8 <= width; x += 8) {
+    __m256i pixels = _mm256_loadu_si256((const __m256i*)(src + x * 4));
+    _mm256_storeu_si256((__m256i*)(dst + x * 4), _mm256_shuffle_epi8(pixels, swizzle));
+  }
+  sgg__rgba_row_scalar(src + x * 4, dst + x * 4, width - x);
+}
+
+SGG__TARGET("avx2")
+static void sgg__y_row_avx2(const uint8_t* src, uint8_t* dst, int width) {
+  const __m256i coeffs = _mm256_setr_epi8(
+    13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0,
+    13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0, 13, 64, 33, 0);
+  const __m256i round  = _mm256_set1_epi16(64);
+  const __m256i offset = _mm256_set1_epi8(16);
+
+  // The in-lane `hadd` and `packus` leave groups of 4 pixels in order
+  // 0, 2, 4, 6, 1, 3, 5, 7.
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+  int x = 0;
+  for (; x + 32 <= width; x += 32) {
+    const __m256i* pixels = (const __m256i*)(src + x * 4);
+
+    __m256i p0 = _mm256_maddubs_epi16(_mm256_loadu_si256(pixels + 0), coeffs);
+    __m256i p1 = _mm256_maddubs_epi16(_mm256_loadu_si256(pixels + 1), coeffs);
+    __m256i p2 = _mm256_maddubs_epi16(_mm256_loadu_si256(pixels + 2), coeffs);
+    __m256i p3 = _mm256_maddubs_epi16(_mm256_loadu_si256(pixels + 3), coeffs);
+
+    __m256i y0 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(p0, p1), round), 7);
+    __m256i y1 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(p2, p3), round), 7);
+
+    __m256i y = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(y0, y1), order);
+    _mm256_storeu_si256((__m256i*)(dst + x), _mm256_add_epi8(y, offset));
+  }
+  sgg__y_row_scalar(src + x * 4, dst + x, width - x);
+}
+#  endif // SGG__X86
+
+#  ifdef SGG__NEON
+static void sgg__rgba_row_neon(const uint8_t* src, uint8_t* dst, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+    uint8x16_t   blue   = pixels.val[0];
+    pixels.val[0]       = pixels.val[2];
+    pixels.val[2]       = blue;
+    vst4q_u8(dst + x * 4, pixels);
+  }
+  sgg__rgba_row_scalar(src + x * 4, dst + x * 4, width - x);
+}
+
+static void sgg__y_row_neon(const uint8_t* src, uint8_t* dst, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+
+    uint16x8_t lo = vmull_u8(vget_low_u8(pixels.val[0]), vdup_n_u8(13));
+    lo            = vmlal_u8(lo, vget_low_u8(pixels.val[1]), vdup_n_u8(64));
+    lo            = vmlal_u8(lo, vget_low_u8(pixels.val[2]), vdup_n_u8(33));
+
+    uint16x8_t hi = vmull_u8(vget_high_u8(pixels.val[0]), vdup_n_u8(13));
+    hi            = vmlal_u8(hi, vget_high_u8(pixels.val[1]), vdup_n_u8(64));
+    hi            = vmlal_u8(hi, vget_high_u8(pixels.val[2]), vdup_n_u8(33));
+
+    uint8x16_t y = vcombine_u8(vrshrn_n_u16(lo, 7), vrshrn_n_u16(hi, 7));
+    vst1q_u8(dst + x, vaddq_u8(y, vdupq_n_u8(16)));
+  }
+  sgg__y_row_scalar(src + x * 4, dst + x, width - x);
+}
+
+static void sgg__uv_row_neon(const uint8_t* src0, const uint8_t* src1, uint8_t* u, uint8_t* v, int width) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    uint8x16x4_t p0 = vld4q_u8(src0 + x * 4);
+    uint8x16x4_t p1 = vld4q_u8(src1 + x * 4);
+
+    int16x8_t bgr[3];
+    for (int c = 0; c < 3; c++) {
+      uint8x16_t column = vrhaddq_u8(p0.val[c], p1.val[c]);
+      bgr[c]            = vreinterpretq_s16_u16(vrshrq_n_u16(vpaddlq_u8(column), 1));
+    }
+
+    int16x8_t u16 = vmulq_n_s16(bgr[0], 112);
+    u16           = vmlsq_n_s16(u16, bgr[1], 74);
+    u16           = vmlsq_n_s16(u16, bgr[2], 38);
+
+    int16x8_t v16 = vmulq_n_s16(bgr[2], 112);
+    v16           = vmlsq_n_s16(v16, bgr[1], 94);
+    v16           = vmlsq_n_s16(v16, bgr[0], 18);
+
+    vst1_u8(u + x / 2, vshrn_n_u16(vaddq_u16(vreinterpretq_u16_s16(u16), vdupq_n_u16(0x8080)), 8));
+    vst1_u8(v + x / 2, vshrn_n_u16(vaddq_u16(vreinterpretq_u16_s16(v16), vdupq_n_u16(0x8080)), 8));
+  }
+  sgg__uv_row_scalar(src0 + x * 4, src1 + x * 4, u + x / 2, v + x / 2, width - x);
+}
+#  endif // SGG__NEON
+
+static bool sgg__select_pixel_kernels(sgg_pixel_kernel kernel, sgg__pixel_kernels* kernels) {
+  if (kernel == SGG_PIXEL_KERNEL_AUTO) {
+#  if defined(SGG__X86)
+    kernel = sgg__cpu_has_avx2() ? SGG_PIXEL_KERNEL_AVX2 : sgg__cpu_has_ssse3() ? SGG_PIXEL_KERNEL_SSSE3 : SGG_PIXEL_KERNEL_SCALAR;
+#  elif defined(SGG__NEON)
+    kernel = SGG_PIXEL_KERNEL_NEON;
+#  else
+    kernel = SGG_PIXEL_KERNEL_SCALAR;
+#  endif
+  }
+
+  switch (kernel) {
+  case SGG_PIXEL_KERNEL_SCALAR:
+    *kernels = (sgg__pixel_kernels){sgg__rgba_row_scalar, sgg__y_row_scalar, sgg__uv_row_scalar};
+    return true;
+#  ifdef SGG__X86
+  case SGG_PIXEL_KERNEL_SSSE3:
+    *kernels = (sgg__pixel_kernels){sgg__rgba_row_ssse3, sgg__y_row_ssse3, sgg__uv_row_ssse3};
+    return sgg__cpu_has_ssse3();
+  case SGG_PIXEL_KERNEL_AVX2:
+    // The chroma rows are a fraction of the work, so they stay on SSSE3.
+    *kernels = (sgg__pixel_kernels){sgg__rgba_row_avx2, sgg__y_row_avx2, sgg__uv_row_ssse3};
+    return sgg__cpu_has_avx2();
+#  endif
+#  ifdef SGG__NEON
+  case SGG_PIXEL_KERNEL_NEON:
+    *kernels = (sgg__pixel_kernels){sgg__rgba_row_neon, sgg__y_row_neon, sgg__uv_row_neon};
+    return true;
+#  endif
+  default:
+    return false;
+  }
+}
+
+static const uint8_t* sgg__source_row(const sgg_readback* readback, int y) {
+  int row = readback->bottom_up ? readback->height - 1 - y : y;
+  return (const uint8_t*)readback->pixels + (size_t)row * (size_t)readback->row_pitch;
+}
+
+static void sgg__convert_pixels(const sgg__pixel_kernels* kernels, const sgg_readback* readback, sgg_capture_format format, uint8_t* dst) {
+  int width  = readback->width;
+  int height = readback->height;
+
+  if (format == SGG_CAPTURE_FORMAT_RGBA) {
+    for (int y = 0; y < height; y++) {
+      kernels->rgba_row(sgg__source_row(readback, y), dst + (size_t)y * (size_t)width * 4, width);
+    }
+    return;
+  }
+
+  int      chroma_width  = (width + 1) / 2;
+  int      chroma_height = (height + 1) / 2;
+  uint8_t* u_plane       = dst + (size_t)width * (size_t)height;
+  uint8_t* v_plane       = u_plane + (size_t)chroma_width * (size_t)chroma_height;
+
+  for (int y = 0; y < height; y++) {
+    kernels->y_row(sgg__source_row(readback, y), dst + (size_t)y * (size_t)width, width);
+  }
+
+  // The last row is repeated for odd heights.
+  for (int y = 0; y < chroma_height; y++) {
+    const uint8_t* src0   = sgg__source_row(readback, y * 2);
+    const uint8_t* src1   = sgg__source_row(readback, sgg__min(y * 2 + 1, height - 1));
+    size_t         offset = (size_t)y * (size_t)chroma_width;
+    kernels->uv_row(src0, src1, u_plane + offset, v_plane + offset, width);
+  }
+}
+
+static uint64_t sgg__capture_frame_size(sgg_capture_format format, int width, int height) {
+  uint64_t pixels = (uint64_t)width * (uint64_t)height;
+  if (format == SGG_CAPTURE_FORMAT_RGBA) {
+    return pixels * 4;
+  }
+  return pixels + 2 * (uint64_t)((width + 1) / 2) * (uint64_t)((height + 1) / 2);
+}
+
+static void sgg__capture_converter_main(void* arg) {
+  sgg__capture* capture = (sgg__capture*)arg;
+  uint32_t      count   = (uint32_t)capture->desc.queue_size;
+
+  sgg__mutex_lock(&capture->mutex);
+  for (;;) {
+    while (capture->converted == capture->head && !capture->stop) {
+      sgg__cond_wait(&capture->convert_cond, &capture->mutex);
+    }
+    if (capture->converted == capture->head) {
+      break;
+    }
+    sgg__capture_slot* slot = &capture->slots[capture->converted % count];
+    sgg__mutex_unlock(&capture->mutex);
+
+    if (!slot->skip) {
+      sgg__convert_pixels(&capture->kernels, &slot->source, capture->desc.format, slot->data);
+    }
+
+    sgg__mutex_lock(&capture->mutex);
+    capture->converted++;
+    sgg__cond_signal(&capture->write_cond);
+  }
+  sgg__mutex_unlock(&capture->mutex);
+}
+
+static void sgg__capture_writer_main(void* arg) {
+  sgg__capture* capture = (sgg__capture*)arg;
+  uint32_t      count   = (uint32_t)capture->desc.queue_size;
+  bool          y4m     = capture->desc.container == SGG_CAPTURE_CONTAINER_Y4M;
+
+  sgg__mutex_lock(&capture->mutex);
+  for (;;) {
+    // The converter drains its slots before it stops.
+    while (capture->tail == capture->converted && !(capture->stop && capture->converted == capture->head)) {
+      sgg__cond_wait(&capture->write_cond, &capture->mutex);
+    }
+    if (capture->tail == capture->converted) {
+      break;
+    }
+    sgg__capture_slot* slot = &capture->slots[capture->tail % count];
+    sgg__mutex_unlock(&capture->mutex);
+
+    uint64_t bytes = 0;
+    if (!slot->skip) {
+      if (y4m) {
+        bytes += fwrite("FRAME\n", 1, 6, capture->file);
+      }
+      bytes += fwrite(slot->data, 1, (size_t)capture->frame_size, capture->file);
+    }
+
+    sgg__mutex_lock(&capture->mutex);
+    capture->tail++;
+    capture->stats.frames_written += slot->skip ? 0 : 1;
+    capture->stats.bytes_written += bytes;
+  }
+  sgg__mutex_unlock(&capture->mutex);
+}
+
+// Called on the presenting thread, before the present.
+static void sgg__capture_request(sgg__context* ctx) {
+  if (!sgg__request_readback(ctx)) {
+    g_sgg_state.capture.stats.frames_dropped++;
+  }
+}
+
+// Called on the presenting thread, after the present. Hands over the frames
+// read back so far, as long as there are free slots.
+static void sgg__capture_collect(sgg__context* ctx) {
+  sgg__capture* capture = &g_sgg_state.capture;
+  uint32_t      count   = (uint32_t)capture->desc.queue_size;
+
+  sgg__mutex_lock(&capture->mutex);
+  uint32_t converted  = capture->converted;
+  uint32_t free_slots = count - (capture->head - capture->tail);
+  sgg__mutex_unlock(&capture->mutex);
+
+  for (; capture->released != converted; capture->released++) {
+    sgg__unmap_readback(ctx);
+  }
+
+  sgg_readback readback;
+  for (; free_slots && sgg__map_readback(ctx, &readback); free_slots--) {
+    if (!capture->frame_size) {
+      capture->width      = readback.width;
+      capture->height     = readback.height;
+      capture->frame_size = sgg__capture_frame_size(capture->desc.format, readback.width, readback.height);
+
+      for (uint32_t i = 0; i < count; i++) {
+        capture->slots[i].data = (uint8_t*)malloc((size_t)capture->frame_size);
+        SOKOL_ASSERT(capture->slots[i].data);
+      }
+
+      if (capture->desc.container == SGG_CAPTURE_CONTAINER_Y4M) {
+        int header = fprintf(capture->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", capture->width, capture->height, capture->desc.fps);
+        capture->stats.bytes_written += header > 0 ? (uint64_t)header : 0;
+      }
+    }
+
+    // The readbacks have to be unmapped in order, so the frames that can't be
+    // written still go through the slots.
+    bool skip = readback.width != capture->width || readback.height != capture->height;
+    if (skip) {
+      capture->stats.frames_dropped++;
+    }
+
+    sgg__mutex_lock(&capture->mutex);
+    sgg__capture_slot* slot = &capture->slots[capture->head % count];
+    slot->source            = readback;
+    slot->skip              = skip;
+    capture->head++;
+    sgg__cond_signal(&capture->convert_cond);
+    sgg__mutex_unlock(&capture->mutex);
+  }
+}
+
+static void sgg__end_capture(void) {
+  sgg__capture* capture = &g_sgg_state.capture;
+
+  sgg__mutex_lock(&capture->mutex);
+  capture->stop = true;
+  sgg__cond_signal(&capture->convert_cond);
+  sgg__cond_signal(&capture->write_cond);
+  sgg__mutex_unlock(&capture->mutex);
+
+  sgg__thread_join(capture->converter_thread);
+  sgg__thread_join(capture->writer_thread);
+
+  // Release the handed over frames, and drop the ones left in flight.
+  sgg__context* ctx = sgg__lookup_context(capture->context_id);
+  if (ctx) {
+    for (; capture->released != capture->converted; capture->released++) {
+      sgg__unmap_readback(ctx);
+    }
+
+    sgg_readback readback;
+    while (sgg__poll_readback(ctx, &readback)) {
+      capture->stats.frames_dropped++;
+    }
+    while (ctx->readback_mapped) {
+      sgg__unmap_readback(ctx);
+    }
+    capture->stats.frames_dropped += ctx->readback_head - ctx->readback_tail;
+
+    // The ring was grown for the capture's queue, which doesn't need to outlive it.
+    sgg__release_readbacks(ctx);
+  }
+
+  for (int i = 0; i < capture->desc.queue_size; i++) {
+    free(capture->slots[i].data);
+  }
+  free(capture->slots);
+  fclose(capture->file);
+
+  sgg__cond_destroy(&capture->write_cond);
+  sgg__cond_destroy(&capture->convert_cond);
+  sgg__mutex_destroy(&capture->mutex);
+
+  sgg_capture_stats stats = capture->stats;
+  *capture                = (sgg__capture){0};
+  capture->stats          = stats;
+}
+#endif // SGG_ENABLE_CAPTURE
+
+#ifdef SGG_ENABLE_EXPORT
+#  define SGG__EXPORT_PAGE_SIZE 4096
+
+static uint64_t sgg__export_page_align(uint64_t size) {
+  return (size + SGG__EXPORT_PAGE_SIZE - 1) & ~(uint64_t)(SGG__EXPORT_PAGE_SIZE - 1);
+}
+
+// Makes room for frames of `frame_size` bytes, at least doubling the slots, so
+// that a window dragged larger grows the shared memory only a few times.
+static bool sgg__grow_export(sgg__export* frame_export, uint64_t frame_size) {
+  if (frame_size <= frame_export->slot_capacity) {
+    return true;
+  }
+
+  uint64_t old_size    = frame_export->header ? frame_export->header->size : 0;
+  uint64_t capacity    = sgg__export_page_align(frame_size > 2 * frame_export->slot_capacity ? frame_size : 2 * frame_export->slot_capacity);
+  uint64_t data_offset = sgg__export_page_align(old_size ? old_size : sizeof(sgg_export_header));
+  uint64_t size        = data_offset + SGG_EXPORT_SLOT_COUNT * capacity;
+
+  if (ftruncate(frame_export->fd, (off_t)size) != 0) {
+    return false;
+  }
+
+  void* memory = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, frame_export->fd, 0);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+  if (frame_export->header) {
+    munmap(frame_export->header, (size_t)old_size);
+  }
+
+  frame_export->header        = (sgg_export_header*)memory;
+  frame_export->data_offset   = data_offset;
+  frame_export->slot_capacity = capacity;
+  sgg__export_store_u64(&frame_export->header->size, size);
+  return true;
+}
+
+// Writes the frame to the slot after the latest one. The sequence number is odd
+// while the pixels are copied, so the consumers still reading the slot's previous
+// frame can tell it was overwritten.
+static bool sgg__publish_export_frame(sgg__export* frame_export, const sgg_readback* readback) {
+  int      stride     = readback->width * 4;
+  uint64_t frame_size = (uint64_t)stride * (uint64_t)readback->height;
+  if (!sgg__grow_export(frame_export, frame_size)) {
+    return false;
+  }
+
+  sgg_export_header* header      = frame_export->header;
+  uint64_t           frame_count = header->frame_count;
+  int                index       = (int)(frame_count % SGG_EXPORT_SLOT_COUNT);
+  sgg_export_slot*   slot        = &header->slots[index];
+  uint64_t           sequence    = slot->sequence;
+
+  __atomic_store_n(&slot->sequence, sequence + 1, __ATOMIC_RELAXED);
+  sgg__export_fence_release();
+
+  slot->frame_id     = readback->frame_index;
+  slot->timestamp_ns = (uint64_t)((double)glfwGetTimerValue() * g_sgg_state.timer_period_ms * 1e6);
+  slot->offset       = frame_export->data_offset + (uint64_t)index * frame_export->slot_capacity;
+  slot->width        = readback->width;
+  slot->height       = readback->height;
+  slot->stride       = stride;
+  slot->format       = SGG_EXPORT_FORMAT_BGRA8;
+
+  uint8_t* dst = (uint8_t*)header + slot->offset;
+  for (int y = 0; y < readback->height; y++) {
+    int src_y = readback->bottom_up ? readback->height - 1 - y : y;
+    memcpy(dst + (size_t)y * (size_t)stride, (const uint8_t*)readback->pixels + (size_t)src_y * (size_t)readback->row_pitch, (size_t)stride);
+  }
+
+  sgg__export_store_u64(&slot->sequence, sequence + 2);
+  sgg__export_store_u64(&header->frame_count, frame_count + 1);
+  return true;
+}
+
+// Called on the presenting thread, before the present.
+static void sgg__export_request(sgg__context* ctx) {
+  if (!sgg__request_readback(ctx)) {
+    g_sgg_state.frame_export.stats.frames_dropped++;
+  }
+}
+
+// Called on the presenting thread, after the present. Publishes the frames read
+// back so far, without waiting for the ones still being copied.
+static void sgg__export_collect(sgg__context* ctx) {
+  sgg__export* frame_export = &g_sgg_state.frame_export;
+
+  sgg_readback readback;
+  while (sgg__map_readback(ctx, &readback)) {
+    if (sgg__publish_export_frame(frame_export, &readback)) {
+      frame_export->stats.frames_published++;
+    } else {
+      frame_export->stats.frames_dropped++;
+    }
+    sgg__unmap_readback(ctx);
+  }
+}
+
+static void sgg__end_export(void) {
+  sgg__export* frame_export = &g_sgg_state.frame_export;
+
+  // Drop the frames left in flight.
+  sgg__context* ctx = sgg__lookup_context(frame_export->context_id);
+  if (ctx) {
+    sgg_readback readback;
+    while (sgg__poll_readback(ctx, &readback)) {
+      frame_export->stats.frames_dropped++;
+    }
+    frame_export->stats.frames_dropped += ctx->readback_head - ctx->readback_tail;
+    ctx->readback_requested = false;
+  }
+
+  if (frame_export->header) {
+    sgg__export_store_u32(&frame_export->header->closed, 1);
+    munmap(frame_export->header, (size_t)frame_export->header->size);
+  }
+  close(frame_export->fd);
+  shm_unlink(frame_export->desc.name);
+
+  sgg_export_stats stats = frame_export->stats;
+  *frame_export          = (sgg__export){0};
+  frame_export->stats    = stats;
+}
+#endif // SGG_ENABLE_EXPORT
+
+static bool sgg__frame_needed(sgg__context* ctx) {
+  if (g_sgg_state.render_thread) {
+    sgg__drain_events(ctx);
+  }
+
+  if (sgg__atomic_load_u32(&ctx->iconified) || ctx->framebuffer_width == 0 || ctx->framebuffer_height == 0) {
+    return false;
+  }
+
+  // Checked first, as the end of the occlusion can mark the window too.
+  if (!sgg__platform_visible(&g_sgg_state, ctx)) {
+    return false;
+  }
+
+  return sgg__atomic_load_u32(&ctx->invalidated) != 0;
+}
+
+static bool sgg__any_frame_needed(void) {
+  bool needed = false;
+  for (int i = 0; i < SGG_MAX_CONTEXTS; i++) {
+    // Not short-circuited, so that every occluded window gets tested.
+    if (g_sgg_state.contexts[i].desc.window && sgg__frame_needed(&g_sgg_state.contexts[i])) {
+      needed = true;
+    }
+  }
+  return needed;
+}
+
+static double sgg__now_ms(void) {
+  if (g_sgg_state.clock_func) {
+    return g_sgg_state.clock_func(g_sgg_state.clock_user_data);
+  }
+  return (double)glfwGetTimerValue() * g_sgg_state.timer_period_ms;
+}
+
+#if defined(_WIN32)
+#  ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#    define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#  endif
+
+static void sgg__os_sleep_ms(double ms) {
+  // High resolution timers need Windows 10 1803, `Sleep` is only as precise as
+  // the system timer (15.6 ms by default).
+  HANDLE timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+  if (!timer) {
+    Sleep((DWORD)ms);
+    return;
+  }
+
+  LARGE_INTEGER due_time = {.QuadPart = -(LONGLONG)(ms * 10000.0)}; // Relative, in 100 ns.
+  if (SetWaitableTimer(timer, &due_time, 0, NULL, NULL, FALSE)) {
+    WaitForSingleObject(timer, INFINITE);
+  }
+  CloseHandle(timer);
+}
+#else
+static void sgg__os_sleep_ms(double ms) {
+  struct timeval timeout = {
+    .tv_sec  = (long)(ms / 1000.0),
+    .tv_usec = (long)(ms * 1000.0) % 1000000,
   };
+  select(0, NULL, NULL, NULL, &timeout);
+}
+#endif
 
-  IDXGISwapChain1* swapchain;
-  hr = IDXGIFactory2_CreateSwapChainForHwnd(
-    factory,
-    (IUnknown*)device,
-    glfwGetWin32Window(state->desc.window),
-    &swapchain_desc,
-    NULL,
-    NULL,
-    &swapchain);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+static double sgg__floor(double x) {
+  double truncated = (double)(int64_t)x;
+  return truncated > x ? truncated - 1.0 : truncated;
+}
+
+static double sgg__refresh_interval_ms(sgg__context* ctx) {
+  uint32_t refresh_rate = sgg__atomic_load_u32(&ctx->refresh_rate);
+  return 1000.0 / (double)(refresh_rate ? refresh_rate : 60);
+}
+
+// The presents land at (or a bit after) the vertical blanks, so the sample that
+// is the earliest in the refresh cycle is the closest to the actual vblank.
+static void sgg__add_vblank_sample(sgg__frame_pacer* pacer, double interval_ms, double time_ms) {
+  if (pacer->vblank_sample_count) {
+    double latest = pacer->vblank_samples[(pacer->next_vblank_sample + SGG__VBLANK_SAMPLES - 1) % SGG__VBLANK_SAMPLES];
+    if (time_ms <= latest) {
+      return; // Reported again, or out of order.
+    }
+  }
+
+  pacer->vblank_samples[pacer->next_vblank_sample] = time_ms;
+  pacer->next_vblank_sample                        = (pacer->next_vblank_sample + 1) % SGG__VBLANK_SAMPLES;
+  pacer->vblank_sample_count                       = sgg__min(pacer->vblank_sample_count + 1, SGG__VBLANK_SAMPLES);
+
+  double earliest_offset = 0.0;
+  for (int i = 0; i < pacer->vblank_sample_count; i++) {
+    double age = time_ms - pacer->vblank_samples[i];
+    if (age > SGG__VBLANK_MAX_AGE_MS) {
+      continue;
+    }
+
+    // Offset from the closest vblank, if there was one at `time_ms`.
+    double offset = interval_ms * sgg__floor(age / interval_ms + 0.5) - age;
+    if (offset < earliest_offset) {
+      earliest_offset = offset;
+    }
+  }
+
+  pacer->vblank_ms  = time_ms + earliest_offset;
+  pacer->has_vblank = true;
+}
+
+// Smoothed like the round-trip time in TCP (RFC 6298).
+static void sgg__add_frame_cost_sample(sgg__frame_pacer* pacer, double cost_ms) {
+  if (!pacer->has_cost) {
+    pacer->cost_ms           = cost_ms;
+    pacer->cost_deviation_ms = cost_ms * 0.5;
+    pacer->has_cost          = true;
+    return;
+  }
+
+  double error = cost_ms - pacer->cost_ms;
+  pacer->cost_ms += error * 0.125;
+  pacer->cost_deviation_ms += ((error < 0.0 ? -error : error) - pacer->cost_deviation_ms) * 0.25;
+}
+
+static sgg_frame_deadline sgg__predict_frame_deadline(const sgg__frame_pacer* pacer, double interval_ms, double margin_ms, double now_ms) {
+  double budget_ms = margin_ms;
+  if (pacer->has_cost) {
+    budget_ms += pacer->cost_ms + 4.0 * pacer->cost_deviation_ms;
+  }
+
+  sgg_frame_deadline deadline = {
+    .vblank_ms           = now_ms + interval_ms,
+    .wake_ms             = now_ms,
+    .refresh_interval_ms = interval_ms,
+    .frame_cost_ms       = pacer->has_cost ? pacer->cost_ms : 0.0,
+  };
+
+  // Without a phase yet, the frame can only start right away.
+  if (pacer->has_vblank) {
+    double periods     = sgg__floor((now_ms + budget_ms - pacer->vblank_ms) / interval_ms) + 1.0;
+    deadline.vblank_ms = pacer->vblank_ms + periods * interval_ms;
+    deadline.wake_ms   = deadline.vblank_ms - budget_ms;
+  }
+
+  return deadline;
+}
+
+static void sgg__begin_pacer_present(sgg__context* ctx) {
+  sgg__frame_pacer* pacer = &ctx->pacer;
+  double            now   = sgg__now_ms();
+
+  if (pacer->has_frame_start) {
+    sgg__add_frame_cost_sample(pacer, now - pacer->frame_start_ms);
+  } else if (pacer->has_last_present) {
+    sgg__add_frame_cost_sample(pacer, now - pacer->last_present_ms);
+  }
+  pacer->has_frame_start = false;
+}
+
+static void sgg__end_pacer_present(sgg__context* ctx, bool vsync) {
+  sgg__frame_pacer* pacer = &ctx->pacer;
+  double            now   = sgg__now_ms();
+
+  pacer->last_present_ms  = now;
+  pacer->has_last_present = true;
+
+  // The backend reports the vblanks in GLFW's timer.
+  double vblank_ms;
+  if (!g_sgg_state.clock_func && sgg__platform_vblank_time(&g_sgg_state, ctx, &vblank_ms)) {
+    sgg__add_vblank_sample(pacer, sgg__refresh_interval_ms(ctx), vblank_ms);
+    pacer->vblank_reported = true;
+  } else if (!pacer->vblank_reported && vsync && ctx->present_mode == SGG_PRESENT_MODE_FIFO) {
+    // Only presents that waited for the vertical blank say anything about it.
+    sgg__add_vblank_sample(pacer, sgg__refresh_interval_ms(ctx), now);
+  }
+}
+
+static void sgg__present_context(sgg__context* ctx, bool vsync) {
+  SGG__TRACE_BEGIN("sgg_present");
+  ctx->dirty = false;
+#ifdef SGG_ENABLE_CAPTURE
+  bool capturing = g_sgg_state.capture.active && sgg__lookup_context(g_sgg_state.capture.context_id) == ctx;
+  if (capturing) {
+    sgg__capture_request(ctx);
+  }
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  bool exporting = g_sgg_state.frame_export.active && sgg__lookup_context(g_sgg_state.frame_export.context_id) == ctx;
+  if (exporting) {
+    sgg__export_request(ctx);
+  }
+#endif
+  if (ctx->readback_requested) {
+    sgg__copy_readback(ctx);
+  }
+  sgg__begin_pacer_present(ctx);
+  SGG__TIMED(ctx, present, sgg__platform_present(&g_sgg_state, ctx, vsync));
+  sgg__end_pacer_present(ctx, vsync);
+  ctx->frame_index++;
+
+  // The next frame is whole, unless `sgg_present_damage` says otherwise.
+  ctx->damage[ctx->frame_index % SGG__DAMAGE_HISTORY].count = 0;
+
+  if (ctx->desc.adaptive_resolution && !ctx->scale.reported) {
+    uint64_t now = glfwGetTimerValue();
+    if (ctx->scale.last_present_ticks) {
+      sgg__update_render_scale(ctx, (double)(now - ctx->scale.last_present_ticks) * g_sgg_state.timer_period_ms);
+    }
+    ctx->scale.last_present_ticks = now;
+  }
+#ifdef SGG_ENABLE_CAPTURE
+  if (capturing) {
+    sgg__capture_collect(ctx);
+  }
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  if (exporting) {
+    sgg__export_collect(ctx);
+  }
+#endif
+  ctx->present_count++;
+  SGG__TRACE_END();
+}
+
+void sgg_environment_begin_async(void) {
+  if (g_sgg_state.valid || g_sgg_state.device_started) {
+    SOKOL_ASSERT(false && "sgg was already initialized");
+    return;
+  }
+
+  g_sgg_state.device_started = true;
+  sgg__platform_begin_init_device(&g_sgg_state);
+}
+
+void sgg_environment_wait(void) {
+  sgg__platform_wait_device(&g_sgg_state);
+}
+
+sg_environment sgg_environment(const sgg_environment_desc* desc) {
+  sgg__validate_desc(desc);
+
+  if (!g_sgg_state.valid) {
+    g_sgg_state.valid              = true;
+    g_sgg_state.render_thread      = desc->render_thread;
+    g_sgg_state.timer_period_ms    = 1000.0 / (double)glfwGetTimerFrequency();
+    g_sgg_state.clock_func         = desc->clock_func;
+    g_sgg_state.clock_user_data    = desc->clock_user_data;
+    g_sgg_state.sleep_slack_ms     = 1.0;
+    g_sgg_state.contexts[0].desc   = *desc;
+    if (!g_sgg_state.device_started) {
+      sgg__platform_init_device(&g_sgg_state);
+    }
+    sgg_environment_wait();
+    if (!sgg__platform_init(&g_sgg_state)) {
+      // E.g., no usable EGL for the headless mode. See `sgg_is_valid`.
+      g_sgg_state = (sgg__state){0};
+      return (sg_environment){0};
+    }
+    sgg__init_context(&g_sgg_state.contexts[0], desc);
+    g_sgg_state.current_context_id = g_sgg_state.contexts[0].id;
+
+    g_sgg_state.prev_monitor_callback = glfwSetMonitorCallback(sgg__monitor_callback);
+  }
+
+  SOKOL_ASSERT(g_sgg_state.contexts[0].desc.window == desc->window);
+
+  sg_environment env = {
+    .defaults = {
+      .color_format = SG_PIXELFORMAT_BGRA8,
+      .depth_format = sgg__depth_pixel_format(desc),
+      .sample_count = sgg__sample_count(desc),
+    },
+  };
+  sgg__platform_environment(&g_sgg_state, &env);
+
+  return env;
+}
+
+bool sgg_is_valid(void) {
+  return g_sgg_state.valid;
+}
+
+sg_swapchain sgg_swapchain(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return (sg_swapchain){0};
+  }
+
+  SGG__TRACE_BEGIN("sgg_swapchain");
+  SGG__TRACE_BEGIN("size_query");
+
+  if (g_sgg_state.render_thread) {
+    sgg__drain_events(ctx);
+  }
+
+  // Marks made from now on are for the next frame.
+  sgg__atomic_store_u32(&ctx->invalidated, 0);
+
+  sgg_size window = {ctx->framebuffer_width, ctx->framebuffer_height};
+  sgg_size render = sgg__render_size(ctx, window);
+  double   now    = ctx->desc.backbuffer_shrink_delay_ms > 0.0 ? glfwGetTime() : 0.0;
+
+  sgg_size new_size;
+  bool     resize = sgg__next_backbuffer_size(ctx, window, render, now, &new_size);
+
+  SGG__TRACE_END();
+
+  if (resize) {
+#ifdef SOKOL_DEBUG
+    printf("Drawable resized: %4d x %4d px\n", new_size.width, new_size.height);
+#endif
+    SGG__TRACE_BEGIN("resize");
+    SGG__TIMED(ctx, resize, sgg__platform_resize_swapchain_backbuffer(&g_sgg_state, ctx, new_size.width, new_size.height));
+    sgg__set_backbuffer_size(ctx, new_size);
+    SGG__TRACE_END();
+  }
+
+  if (ctx->recorded_events) {
+    sgg__record_window_event(ctx, (sgg_window_event){.type = SGG_WINDOW_EVENT_FRAME});
+  }
+
+  ctx->dirty          = true;
+  ctx->swapchain_size = render;
+
+  sg_swapchain swapchain = {
+    .width        = render.width,
+    .height       = render.height,
+    .sample_count = sgg__sample_count(&ctx->desc),
+    .color_format = SG_PIXELFORMAT_BGRA8,
+    .depth_format = sgg__depth_pixel_format(&ctx->desc),
+  };
+  SGG__TRACE_BEGIN("acquire");
+  SGG__TIMED(ctx, acquire, sgg__platform_swapchain(&g_sgg_state, ctx, &swapchain));
+  SGG__TRACE_END();
+
+  SGG__TRACE_END();
+  return swapchain;
+}
+
+void sgg_present(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  sgg__present_context(ctx, true);
+}
+
+void sgg_present_damage(const sgg_rect* rects, int count) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+  SOKOL_ASSERT(count >= 0 && (rects || count == 0));
+
+  // Clipped to the swapchain. If nothing is left, the whole frame is presented.
+  sgg__damage* damage = &ctx->damage[ctx->frame_index % SGG__DAMAGE_HISTORY];
+  damage->size        = ctx->swapchain_size;
+  damage->count       = 0;
+
+  for (int i = 0; i < count; i++) {
+    int left   = sgg__max(rects[i].x, 0);
+    int top    = sgg__max(rects[i].y, 0);
+    int right  = sgg__min(rects[i].x + rects[i].width, damage->size.width);
+    int bottom = sgg__min(rects[i].y + rects[i].height, damage->size.height);
+    if (right > left && bottom > top) {
+      sgg__add_damage_rect(damage, (sgg_rect){left, top, right - left, bottom - top});
+    }
+  }
+
+  sgg__present_context(ctx, true);
+}
+
+// Waits at most once per frame, as the D3D11 waitable object is signaled once
+// per presented frame.
+static void sgg__wait_for_frame(sgg__context* ctx) {
+  if (ctx->waited_frame_index != ctx->frame_index + 1) {
+    ctx->waited_frame_index = ctx->frame_index + 1;
+    sgg__platform_wait_for_frame(&g_sgg_state, ctx);
+  }
+}
+
+void sgg_wait_for_frame(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  sgg__wait_for_frame(ctx);
+}
+
+uint64_t sgg_frame_index(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return 0;
+  }
+
+  return ctx->frame_index;
+}
+
+int sgg_frames_in_flight(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return 0;
+  }
+
+  return sgg__max_frames_in_flight(&ctx->desc);
+}
+
+sgg_ring sgg_make_ring(const sgg_ring_desc* desc) {
+  SOKOL_ASSERT(desc);
+  SOKOL_ASSERT(desc->buffers);
+  SOKOL_ASSERT(desc->buffer_count > 0 && desc->buffer_count <= SGG__MAX_FRAMES_IN_FLIGHT);
+  SOKOL_ASSERT(desc->size > 0);
+  SOKOL_ASSERT(desc->alignment >= 0 && (desc->alignment & (desc->alignment - 1)) == 0);
+
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return (sgg_ring){0};
+  }
+
+  SOKOL_ASSERT(desc->buffer_count >= sgg__max_frames_in_flight(&ctx->desc) && "not enough buffers for the frames in flight");
+
+  // Otherwise, `sg_update_buffer` in `sgg_ring_flush` fails the validation, and
+  // the frame's data is silently dropped.
+  for (int i = 0; i < desc->buffer_count; i++) {
+    sg_buffer_desc buffer_desc = sg_query_buffer_desc(desc->buffers[i]);
+    SOKOL_ASSERT((size_t)desc->size <= buffer_desc.size && "ring size exceeds the buffer size");
+    SOKOL_ASSERT(buffer_desc.usage != SG_USAGE_IMMUTABLE && "ring buffers must be updatable");
+    _SOKOL_UNUSED(buffer_desc);
+  }
+
+  for (uint32_t i = 0; i < SGG_MAX_RINGS; i++) {
+    sgg__ring* ring = &g_sgg_state.rings[i];
+    if (ring->context_id) {
+      continue;
+    }
+
+    *ring = (sgg__ring){
+      .context_id   = g_sgg_state.current_context_id,
+      .buffer_count = desc->buffer_count,
+      .size         = desc->size,
+      .alignment    = desc->alignment ? desc->alignment : SGG__DEFAULT_RING_ALIGNMENT,
+      .staging      = (uint8_t*)malloc((size_t)desc->size),
+      .frame_index  = UINT64_MAX,
+    };
+    for (int j = 0; j < desc->buffer_count; j++) {
+      ring->buffers[j] = desc->buffers[j];
+    }
+    return (sgg_ring){i + 1};
+  }
+
+  SOKOL_ASSERT(false && "too many rings, increase SGG_MAX_RINGS");
+  return (sgg_ring){0};
+}
+
+static sgg__ring* sgg__lookup_ring(uint32_t id) {
+  if (!g_sgg_state.valid || id == 0 || id > SGG_MAX_RINGS) {
+    return NULL;
+  }
+
+  sgg__ring* ring = &g_sgg_state.rings[id - 1];
+  return ring->context_id ? ring : NULL;
+}
+
+void sgg_destroy_ring(sgg_ring ring_id) {
+  sgg__ring* ring = sgg__lookup_ring(ring_id.id);
+  if (!ring) {
+    return;
+  }
+
+  free(ring->staging);
+  *ring = (sgg__ring){0};
+}
+
+// Starts over in the next buffer on the first use in a frame, once the frame
+// that last used it is done.
+static sgg__ring* sgg__begin_ring_frame(sgg_ring ring_id) {
+  sgg__ring*    ring = sgg__lookup_ring(ring_id.id);
+  sgg__context* ctx  = ring ? sgg__lookup_context(ring->context_id) : NULL;
+  if (!ctx) {
+    SOKOL_ASSERT(false && "invalid ring");
+    return NULL;
+  }
+
+  if (ring->frame_index != ctx->frame_index) {
+    sgg__wait_for_frame(ctx);
+    ring->frame_index = ctx->frame_index;
+    ring->used        = 0;
+    ring->flushed     = false;
+  }
+  return ring;
+}
+
+void* sgg_ring_alloc(sgg_ring ring_id, int size, int* offset) {
+  SOKOL_ASSERT(size > 0);
+  SOKOL_ASSERT(offset);
+
+  sgg__ring* ring = sgg__begin_ring_frame(ring_id);
+  if (!ring) {
+    return NULL;
+  }
+
+  SOKOL_ASSERT(!ring->flushed && "sgg_ring_alloc called after sgg_ring_flush in the same frame");
+
+  int start = (ring->used + ring->alignment - 1) & ~(ring->alignment - 1);
+  if (start > ring->size || size > ring->size - start) {
+    return NULL;
+  }
+
+  ring->used = start + size;
+  *offset    = start;
+  return ring->staging + start;
+}
+
+sg_buffer sgg_ring_buffer(sgg_ring ring_id) {
+  sgg__ring* ring = sgg__begin_ring_frame(ring_id);
+  if (!ring) {
+    return (sg_buffer){0};
+  }
+
+  return ring->buffers[ring->frame_index % (uint64_t)ring->buffer_count];
+}
 
-  IDXGIFactory2_Release(factory);
-  IDXGIAdapter1_Release(adapter);
-  IDXGIDevice1_Release(dxgi_device);
+void sgg_ring_flush(sgg_ring ring_id) {
+  sgg__ring* ring = sgg__begin_ring_frame(ring_id);
+  if (!ring || ring->flushed) {
+    return;
+  }
 
-  state->base_device         = base_device;
-  state->base_device_context = base_device_context;
-  state->device              = device;
-  state->device_context      = device_context;
-  state->swapchain           = swapchain;
-  state->swapchain_desc      = swapchain_desc;
+  // sokol_gfx allows a single update per buffer and frame.
+  ring->flushed = true;
+  if (ring->used > 0) {
+    sg_range data = {ring->staging, (size_t)ring->used};
+    sg_update_buffer(ring->buffers[ring->frame_index % (uint64_t)ring->buffer_count], &data);
+  }
 }
 
-static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
-  env->d3d11.device         = state->base_device;
-  env->d3d11.device_context = state->base_device_context;
+void sgg_present_all(void) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  int last = -1;
+  for (int i = 0; i < SGG_MAX_CONTEXTS; i++) {
+    if (g_sgg_state.contexts[i].desc.window && g_sgg_state.contexts[i].dirty) {
+      last = i;
+    }
+  }
+
+  // Only the last present waits for the vertical blank, so that the frame isn't
+  // throttled once per window.
+  for (int i = 0; i <= last; i++) {
+    sgg__context* ctx = &g_sgg_state.contexts[i];
+    if (ctx->desc.window && ctx->dirty) {
+      sgg__present_context(ctx, i == last);
+    }
+  }
 }
 
-static void sgg__platform_swapchain_backbuffer_size(sgg__state* state, double* width, double* height) {
-  *width  = state->swapchain_desc.Width;
-  *height = state->swapchain_desc.Height;
+void sgg_shutdown(void) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+#ifdef SGG_ENABLE_CAPTURE
+  if (g_sgg_state.capture.active) {
+    sgg__end_capture();
+  }
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  if (g_sgg_state.frame_export.active) {
+    sgg__end_export();
+  }
+#endif
+#ifdef SGG_ENABLE_TRACE
+  if (g_sgg_state.contexts[0].desc.trace_path) {
+    sgg__write_trace(g_sgg_state.contexts[0].desc.trace_path);
+  }
+#endif
+
+  for (int i = SGG_MAX_CONTEXTS - 1; i >= 0; i--) {
+    if (g_sgg_state.contexts[i].desc.window) {
+      sgg__shutdown_context(&g_sgg_state.contexts[i]);
+    }
+  }
+  sgg__platform_shutdown(&g_sgg_state);
+
+  for (int i = 0; i < SGG_MAX_RINGS; i++) {
+    free(g_sgg_state.rings[i].staging);
+  }
+
+  if (glfwSetMonitorCallback(g_sgg_state.prev_monitor_callback) != sgg__monitor_callback) {
+    glfwSetMonitorCallback(NULL);
+  }
+
+  g_sgg_state = (sgg__state){0};
 }
 
-static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, int width, int height) {
-  if (state->render_target_view) {
-    ID3D11RenderTargetView_Release(state->render_target_view);
+sgg_context sgg_make_context(const sgg_environment_desc* desc) {
+  sgg__validate_desc(desc);
+
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return (sgg_context){0};
+  }
+
+  // The headless context has no window system to share with.
+  SOKOL_ASSERT(!desc->headless && !g_sgg_state.contexts[0].desc.headless && "headless mode has a single context");
+
+  for (uint32_t i = 0; i < SGG_MAX_CONTEXTS; i++) {
+    SOKOL_ASSERT(g_sgg_state.contexts[i].desc.window != desc->window && "window already has a context");
   }
 
-  if (width == 0 || height == 0) {
+  for (uint32_t i = 1; i < SGG_MAX_CONTEXTS; i++) {
+    if (!g_sgg_state.contexts[i].desc.window) {
+      sgg__init_context(&g_sgg_state.contexts[i], desc);
+      return (sgg_context){g_sgg_state.contexts[i].id};
+    }
+  }
+
+  SOKOL_ASSERT(false && "too many contexts, increase SGG_MAX_CONTEXTS");
+  return (sgg_context){0};
+}
+
+void sgg_destroy_context(sgg_context ctx_id) {
+  sgg__context* ctx = sgg__lookup_context(ctx_id.id);
+  if (!ctx) {
     return;
   }
 
-  state->swapchain_desc.Width  = (UINT)width;
-  state->swapchain_desc.Height = (UINT)height;
+  if (ctx == &g_sgg_state.contexts[0]) {
+    SOKOL_ASSERT(false && "the default context is destroyed in sgg_shutdown");
+    return;
+  }
 
-  HRESULT hr = IDXGISwapChain1_ResizeBuffers(state->swapchain, 0, (UINT)width, (UINT)height, DXGI_FORMAT_B8G8R8A8_UNORM, 0);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+  if (g_sgg_state.current_context_id == ctx_id.id) {
+    g_sgg_state.current_context_id = g_sgg_state.contexts[0].id;
+  }
 
-  ID3D11Texture2D* backbuffer;
-  hr = IDXGISwapChain1_GetBuffer(state->swapchain, 0, &IID_ID3D11Texture2D, (void**)&backbuffer);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+#ifdef SGG_ENABLE_CAPTURE
+  if (g_sgg_state.capture.active && g_sgg_state.capture.context_id == ctx_id.id) {
+    sgg__end_capture();
+  }
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  if (g_sgg_state.frame_export.active && g_sgg_state.frame_export.context_id == ctx_id.id) {
+    sgg__end_export();
+  }
+#endif
 
-  hr = ID3D11Device_CreateRenderTargetView(state->device, (ID3D11Resource*)backbuffer, NULL, &state->render_target_view);
-  SOKOL_ASSERT(SUCCEEDED(hr));
+  sgg__shutdown_context(ctx);
+}
 
-  ID3D11Texture2D_Release(backbuffer);
+void sgg_set_context(sgg_context ctx_id) {
+  SOKOL_ASSERT(sgg__lookup_context(ctx_id.id));
+  g_sgg_state.current_context_id = ctx_id.id;
 }
 
-static void sgg__platform_swapchain(sgg__state* state, sg_swapchain* swapchain) {
-  swapchain->d3d11.render_view = state->render_target_view;
+sgg_context sgg_get_context(void) {
+  return (sgg_context){g_sgg_state.current_context_id};
 }
 
-static void sgg__platform_present(sgg__state* state) {
-  HRESULT hr = IDXGISwapChain1_Present(state->swapchain, state->desc.vsync_disabled ? 0 : 1, 0);
-  SOKOL_ASSERT(SUCCEEDED(hr));
-  _SOKOL_UNUSED(hr);
+sgg_context sgg_default_context(void) {
+  return (sgg_context){g_sgg_state.valid ? g_sgg_state.contexts[0].id : 0u};
 }
 
-static void sgg__platform_shutdown(sgg__state* state) {
-  ID3D11Device_Release(state->base_device);
-  ID3D11DeviceContext_Release(state->base_device_context);
-  ID3D11Device1_Release(state->device);
-  ID3D11DeviceContext1_Release(state->device_context);
-  IDXGISwapChain1_Release(state->swapchain);
-  ID3D11RenderTargetView_Release(state->render_target_view);
+void sgg_set_present_mode(sgg_present_mode mode) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+  SOKOL_ASSERT(mode >= SGG_PRESENT_MODE_FIFO && mode <= SGG_PRESENT_MODE_IMMEDIATE);
 
-#  ifdef SOKOL_DEBUG
-  IDXGIDebug* debug;
-  if (SUCCEEDED(DXGIGetDebugInterface1(0, &IID_IDXGIDebug, (void**)&debug))) {
-    debug->lpVtbl->ReportLiveObjects(debug, DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_DETAIL);
-    debug->lpVtbl->Release(debug);
+  ctx->desc.present_mode = mode;
+  ctx->present_mode      = sgg__platform_present_mode(&g_sgg_state, mode);
+}
+
+sgg_present_mode sgg_get_present_mode(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return SGG_PRESENT_MODE_FIFO;
   }
-#  endif // SOKOL_DEBUG
+
+  return ctx->present_mode;
 }
-#elif defined(SOKOL_METAL)
-static void sgg__platform_init(sgg__state* state) {
-  id<MTLDevice> device = MTLCreateSystemDefaultDevice();
 
-  CAMetalLayer* layer      = [CAMetalLayer layer];
-  layer.opaque             = YES;
-  layer.device             = device;
-  layer.pixelFormat        = MTLPixelFormatBGRA8Unorm;
-  layer.displaySyncEnabled = !state->desc.vsync_disabled;
+void sgg_render_thread_begin(void) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
 
-  NSWindow* ns_window              = glfwGetCocoaWindow(state->desc.window);
-  ns_window.contentView.layer      = layer;
-  ns_window.contentView.wantsLayer = YES;
+  SOKOL_ASSERT(g_sgg_state.render_thread && "render_thread mode is not enabled");
+  sgg__platform_render_thread_begin(&g_sgg_state);
+}
 
-  state->layer    = layer;
-  state->device   = device;
-  state->drawable = nil;
+void sgg_render_thread_end(void) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  SOKOL_ASSERT(g_sgg_state.render_thread && "render_thread mode is not enabled");
+  sgg__platform_render_thread_end(&g_sgg_state);
 }
 
-static void sgg__platform_environment(const sgg__state* state, sg_environment* env) {
-  env->metal.device = (__bridge const void*)state->device;
+void sgg_invalidate(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  sgg__atomic_store_u32(&ctx->invalidated, 1);
 }
 
-static void sgg__platform_swapchain_backbuffer_size(sgg__state* state, double* width, double* height) {
-  *width  = state->layer.drawableSize.width;
-  *height = state->layer.drawableSize.height;
+bool sgg_frame_needed(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return false;
+  }
+
+  return sgg__frame_needed(ctx);
 }
 
-static void sgg__platform_resize_swapchain_backbuffer(sgg__state* state, int width, int height) {
-  state->layer.drawableSize = CGSizeMake(width, height);
+bool sgg_wait_events(double timeout) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return false;
+  }
+  SOKOL_ASSERT(!g_sgg_state.render_thread);
+  SOKOL_ASSERT(timeout > 0.0);
+
+  if (sgg__any_frame_needed()) {
+    glfwPollEvents();
+  } else {
+    glfwWaitEventsTimeout(timeout);
+  }
+
+  return sgg__any_frame_needed();
 }
 
-static void sgg__platform_swapchain(sgg__state* state, sg_swapchain* swapchain) {
-  state->drawable = [state->layer nextDrawable];
+double sgg_time_ms(void) {
+  if (!g_sgg_state.valid) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return 0.0;
+  }
 
-  swapchain->metal.current_drawable = (__bridge const void*)state->drawable;
+  return sgg__now_ms();
 }
 
-static void sgg__platform_present(sgg__state* state) {
-  _SOKOL_UNUSED(state);
+sgg_frame_deadline sgg_next_frame_deadline(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return (sgg_frame_deadline){0};
+  }
+
+  double margin_ms = ctx->desc.frame_deadline_margin_ms > 0.0 ? ctx->desc.frame_deadline_margin_ms : 1.0;
+  return sgg__predict_frame_deadline(&ctx->pacer, sgg__refresh_interval_ms(ctx), margin_ms, sgg__now_ms());
 }
 
-static void sgg__platform_shutdown(sgg__state* state) {
-  _SOKOL_UNUSED(state);
+void sgg_sleep_until(double time_ms) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
+  }
+
+  // The OS sleep is cut short by the worst recent oversleep (decaying slowly),
+  // and the rest is spun.
+  for (double now = sgg__now_ms(); now < time_ms; now = sgg__now_ms()) {
+    double sleep_ms = time_ms - now - g_sgg_state.sleep_slack_ms;
+    if (sleep_ms < 0.5) {
+      continue;
+    }
+
+    sgg__os_sleep_ms(sleep_ms);
+
+    double overslept_ms = sgg__now_ms() - now - sleep_ms;
+    double slack_ms     = g_sgg_state.sleep_slack_ms;
+    slack_ms            = overslept_ms > slack_ms ? overslept_ms : slack_ms * 0.98 + overslept_ms * 0.02;
+
+    g_sgg_state.sleep_slack_ms = slack_ms < 0.25 ? 0.25 : slack_ms > SGG__MAX_SLEEP_SLACK_MS ? SGG__MAX_SLEEP_SLACK_MS : slack_ms;
+  }
+
+  ctx->pacer.frame_start_ms  = sgg__now_ms();
+  ctx->pacer.has_frame_start = true;
 }
-#endif // SOKOL_* backend
 
-static double sgg__resolve_size(double current_size, double requested_size, double min_size, bool never_downsize) {
-  if (min_size > requested_size) {
-    requested_size = min_size;
+float sgg_render_scale(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return 1.0f;
   }
 
-  if (requested_size < current_size && never_downsize) {
-    return current_size;
+  return ctx->desc.adaptive_resolution ? (float)ctx->scale.steps / SGG__SCALE_STEPS : 1.0f;
+}
+
+void sgg_report_frame_time(double ms) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return;
   }
 
-  return requested_size;
+  if (ctx->desc.adaptive_resolution) {
+    ctx->scale.reported = true;
+    sgg__update_render_scale(ctx, ms);
+  }
 }
 
-sg_environment sgg_environment(const sgg_environment_desc* desc) {
-  SOKOL_ASSERT(desc);
-  SOKOL_ASSERT(desc->window);
-  SOKOL_ASSERT(desc->backbuffer_min_width >= 0);
-  SOKOL_ASSERT(desc->backbuffer_min_height >= 0);
+// Whether the current context's readbacks are owned by a running capture or
+// export.
+static bool sgg__readbacks_in_use(void) {
+#ifdef SGG_ENABLE_CAPTURE
+  if (g_sgg_state.capture.active && g_sgg_state.capture.context_id == g_sgg_state.current_context_id) {
+    SOKOL_ASSERT(false && "the context is being captured");
+    return true;
+  }
+#endif
+#ifdef SGG_ENABLE_EXPORT
+  if (g_sgg_state.frame_export.active && g_sgg_state.frame_export.context_id == g_sgg_state.current_context_id) {
+    SOKOL_ASSERT(false && "the context's frames are being exported");
+    return true;
+  }
+#endif
+  return false;
+}
 
-  if (!g_sgg_state.desc.window) {
-    g_sgg_state.desc = *desc;
-    sgg__platform_init(&g_sgg_state);
+bool sgg_request_readback(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return false;
+  }
+  if (sgg__readbacks_in_use()) {
+    return false;
   }
 
-  SOKOL_ASSERT(g_sgg_state.desc.window == desc->window);
+  return sgg__request_readback(ctx);
+}
 
-  sg_environment env = {
-    .defaults = {
-      .color_format = SG_PIXELFORMAT_BGRA8,
-      .depth_format = SG_PIXELFORMAT_NONE,
-      .sample_count = 1,
-    },
-  };
-  sgg__platform_environment(&g_sgg_state, &env);
+bool sgg_poll_readback(sgg_readback* readback) {
+  SOKOL_ASSERT(readback);
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return false;
+  }
+  if (sgg__readbacks_in_use()) {
+    return false;
+  }
 
-  return env;
+  return sgg__poll_readback(ctx, readback);
 }
 
-sg_swapchain sgg_swapchain(void) {
-  if (!g_sgg_state.desc.window) {
+sgg_frame_stats sgg_query_frame_stats(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
     SOKOL_ASSERT(false && "sgg was not initialized");
-    return (sg_swapchain){0};
+    return (sgg_frame_stats){0};
   }
 
-  int width, height;
-  glfwGetFramebufferSize(g_sgg_state.desc.window, &width, &height);
+  sgg_frame_stats stats = {
+    .frame_count      = ctx->present_count,
+    .resize_count     = ctx->resize_count,
+    .backbuffer_bytes = ctx->backbuffer_bytes,
+  };
 
-  double curr_width, curr_height;
-  sgg__platform_swapchain_backbuffer_size(&g_sgg_state, &curr_width, &curr_height);
+#ifdef SGG_ENABLE_FRAME_STATS
+  stats.acquire = sgg__timing_summary(&ctx->stats.acquire);
+  stats.present = sgg__timing_summary(&ctx->stats.present);
+  stats.resize  = sgg__timing_summary(&ctx->stats.resize);
+#endif
 
-  // clang-format off
-  double new_width  = sgg__resolve_size(curr_width , width , g_sgg_state.desc.backbuffer_min_width , g_sgg_state.desc.backbuffer_never_downsize);
-  double new_height = sgg__resolve_size(curr_height, height, g_sgg_state.desc.backbuffer_min_height, g_sgg_state.desc.backbuffer_never_downsize);
-  // clang-format on
+  return stats;
+}
 
-  if (new_width != curr_width || new_height != curr_height) {
-#ifdef SOKOL_DEBUG
-    printf("Drawable resized: %4.0f x %4.0f px\n", new_width, new_height);
+void sgg_trace_begin(const char* name) {
+  SOKOL_ASSERT(name);
+#ifdef SGG_ENABLE_TRACE
+  sgg__trace_record(name);
+#else
+  _SOKOL_UNUSED(name);
+#endif
+}
+
+void sgg_trace_end(void) {
+  SGG__TRACE_END();
+}
+
+bool sgg_write_trace(const char* path) {
+  SOKOL_ASSERT(path);
+#ifdef SGG_ENABLE_TRACE
+  return sgg__write_trace(path);
+#else
+  _SOKOL_UNUSED(path);
+  return false;
+#endif
+}
+
+#ifdef SGG_ENABLE_CAPTURE
+bool sgg_begin_capture(const sgg_capture_desc* desc) {
+  SOKOL_ASSERT(desc);
+  SOKOL_ASSERT(desc->path);
+  SOKOL_ASSERT(desc->container != SGG_CAPTURE_CONTAINER_Y4M || desc->format == SGG_CAPTURE_FORMAT_I420);
+  SOKOL_ASSERT(desc->fps >= 0);
+  SOKOL_ASSERT(desc->queue_size >= 0);
+
+  if (!sgg__current_context()) {
+    SOKOL_ASSERT(false && "sgg was not initialized");
+    return false;
+  }
+
+  sgg__capture* capture = &g_sgg_state.capture;
+  if (capture->active) {
+    SOKOL_ASSERT(false && "a capture is already running");
+    return false;
+  }
+#ifdef SGG_ENABLE_EXPORT
+  if (g_sgg_state.frame_export.active && g_sgg_state.frame_export.context_id == g_sgg_state.current_context_id) {
+    SOKOL_ASSERT(false && "the context's frames are being exported");
+    return false;
+  }
 #endif
-    SOKOL_ASSERT(new_width == (int)new_width);
-    SOKOL_ASSERT(new_height == (int)new_height);
-    sgg__platform_resize_swapchain_backbuffer(&g_sgg_state, (int)new_width, (int)new_height);
+
+  sgg__pixel_kernels kernels;
+  if (!sgg__select_pixel_kernels(desc->kernel, &kernels)) {
+    return false;
   }
 
-  sg_swapchain swapchain = {
-    .width        = width,
-    .height       = height,
-    .sample_count = 1,
-    .color_format = SG_PIXELFORMAT_BGRA8,
-    .depth_format = SG_PIXELFORMAT_NONE,
+  FILE* file = fopen(desc->path, "wb");
+  if (!file) {
+    return false;
+  }
+
+  *capture = (sgg__capture){
+    .active     = true,
+    .context_id = g_sgg_state.current_context_id,
+    .desc       = *desc,
+    .kernels    = kernels,
+    .file       = file,
   };
-  sgg__platform_swapchain(&g_sgg_state, &swapchain);
 
-  return swapchain;
+  if (!capture->desc.fps) {
+    capture->desc.fps = 60;
+  }
+  if (!capture->desc.queue_size) {
+    capture->desc.queue_size = 3;
+  }
+
+  capture->slots = (sgg__capture_slot*)calloc((size_t)capture->desc.queue_size, sizeof(sgg__capture_slot));
+  SOKOL_ASSERT(capture->slots);
+
+  // The frames queued for the writer stay mapped, so they'd take up the ring's
+  // staging buffers otherwise, leaving none for the frames in flight.
+  sgg__reserve_readbacks(sgg__current_context(), (uint32_t)capture->desc.queue_size + SGG_READBACK_COUNT);
+
+  sgg__mutex_init(&capture->mutex);
+  sgg__cond_init(&capture->convert_cond);
+  sgg__cond_init(&capture->write_cond);
+  sgg__thread_create(&capture->converter_thread, sgg__capture_converter_main, capture);
+  sgg__thread_create(&capture->writer_thread, sgg__capture_writer_main, capture);
+
+  return true;
 }
 
-void sgg_present(void) {
-  if (!g_sgg_state.desc.window) {
+void sgg_end_capture(void) {
+  if (g_sgg_state.capture.active) {
+    sgg__end_capture();
+  }
+}
+
+sgg_capture_stats sgg_query_capture_stats(void) {
+  sgg__capture* capture = &g_sgg_state.capture;
+  if (!capture->active) {
+    return capture->stats;
+  }
+
+  sgg__mutex_lock(&capture->mutex);
+  sgg_capture_stats stats = capture->stats;
+  sgg__mutex_unlock(&capture->mutex);
+
+  return stats;
+}
+
+uint64_t sgg_capture_frame_size(sgg_capture_format format, int width, int height) {
+  return sgg__capture_frame_size(format, width, height);
+}
+
+bool sgg_convert_pixels(const sgg_readback* readback, sgg_capture_format format, sgg_pixel_kernel kernel, void* dst) {
+  SOKOL_ASSERT(readback && readback->pixels);
+  SOKOL_ASSERT(dst);
+
+  sgg__pixel_kernels kernels;
+  if (!sgg__select_pixel_kernels(kernel, &kernels)) {
+    return false;
+  }
+
+  sgg__convert_pixels(&kernels, readback, format, (uint8_t*)dst);
+  return true;
+}
+#endif // SGG_ENABLE_CAPTURE
+
+#ifdef SGG_ENABLE_EXPORT
+bool sgg_begin_export(const sgg_export_desc* desc) {
+  SOKOL_ASSERT(desc);
+  SOKOL_ASSERT(desc->name && desc->name[0] == '/');
+  SOKOL_ASSERT(desc->max_width >= 0 && desc->max_height >= 0);
+
+  if (!sgg__current_context()) {
     SOKOL_ASSERT(false && "sgg was not initialized");
-    return;
+    return false;
+  }
+
+  sgg__export* frame_export = &g_sgg_state.frame_export;
+  if (frame_export->active) {
+    SOKOL_ASSERT(false && "an export is already running");
+    return false;
+  }
+#  ifdef SGG_ENABLE_CAPTURE
+  if (g_sgg_state.capture.active && g_sgg_state.capture.context_id == g_sgg_state.current_context_id) {
+    SOKOL_ASSERT(false && "the context is being captured");
+    return false;
+  }
+#  endif
+
+  // A leftover of a previous run could be open in the consumers, with a
+  // different layout.
+  shm_unlink(desc->name);
+  int fd = shm_open(desc->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) {
+    return false;
+  }
+
+  *frame_export = (sgg__export){
+    .context_id = g_sgg_state.current_context_id,
+    .desc       = *desc,
+    .fd         = fd,
+  };
+
+  uint64_t frame_size = (uint64_t)desc->max_width * (uint64_t)desc->max_height * 4;
+  if (!sgg__grow_export(frame_export, frame_size ? frame_size : 1)) {
+    close(fd);
+    shm_unlink(desc->name);
+    *frame_export = (sgg__export){0};
+    return false;
   }
 
-  sgg__platform_present(&g_sgg_state);
+  frame_export->header->version = SGG_EXPORT_VERSION;
+  sgg__export_store_u32(&frame_export->header->magic, SGG_EXPORT_MAGIC);
+
+  frame_export->active = true;
+  return true;
 }
 
-void sgg_shutdown(void) {
-  if (!g_sgg_state.desc.window) {
+void sgg_end_export(void) {
+  if (g_sgg_state.frame_export.active) {
+    sgg__end_export();
+  }
+}
+
+sgg_export_stats sgg_query_export_stats(void) {
+  return g_sgg_state.frame_export.stats;
+}
+#endif // SGG_ENABLE_EXPORT
+
+void sgg_begin_window_recording(sgg_window_event* events, int capacity) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
     SOKOL_ASSERT(false && "sgg was not initialized");
     return;
   }
+  SOKOL_ASSERT(events && capacity > 0);
 
-  sgg__platform_shutdown(&g_sgg_state);
+  ctx->recorded_events   = events;
+  ctx->recorded_capacity = capacity;
+  ctx->recorded_count    = 0;
+  ctx->recording_start   = glfwGetTime();
 
-  g_sgg_state = (sgg__state){0};
+  // The replay has to start from the same state.
+  sgg__record_window_event(ctx, (sgg_window_event){
+    .type    = SGG_WINDOW_EVENT_MONITOR,
+    .width   = ctx->framebuffer_width,
+    .height  = ctx->framebuffer_height,
+    .x_scale = ctx->content_scale_x,
+    .y_scale = ctx->content_scale_y,
+  });
+  if (ctx->desc.backbuffer_fit_monitor) {
+    sgg__record_window_event(ctx, (sgg_window_event){
+      .type   = SGG_WINDOW_EVENT_MONITOR_SIZE,
+      .width  = ctx->monitor_size.width,
+      .height = ctx->monitor_size.height,
+    });
+  }
 }
 
-void sgg_toggle_vsync(void) {
-  if (!g_sgg_state.desc.window) {
+int sgg_end_window_recording(void) {
+  sgg__context* ctx = sgg__current_context();
+  if (!ctx) {
     SOKOL_ASSERT(false && "sgg was not initialized");
-    return;
+    return 0;
+  }
+
+  int count              = ctx->recorded_count;
+  ctx->recorded_events   = NULL;
+  ctx->recorded_capacity = 0;
+  ctx->recorded_count    = 0;
+
+  return count;
+}
+
+sgg_resize_sim_result sgg_simulate_resize(const sgg_environment_desc* desc, const sgg_window_event* events, int event_count) {
+  SOKOL_ASSERT(desc);
+  SOKOL_ASSERT(events || event_count == 0);
+
+  // Not registered anywhere, so no GLFW callback or backend ever sees it. The
+  // adaptive resolution needs real frame times, so it's left out.
+  sgg__context ctx             = {0};
+  ctx.desc                     = *desc;
+  ctx.desc.window              = NULL;
+  ctx.desc.adaptive_resolution = false;
+  ctx.content_scale_x          = 1.0f;
+  ctx.content_scale_y          = 1.0f;
+
+  sgg_resize_sim_result result = {0};
+
+  for (int i = 0; i < event_count; i++) {
+    const sgg_window_event* event = &events[i];
+
+    if (event->type == SGG_WINDOW_EVENT_FRAMEBUFFER_SIZE || event->type == SGG_WINDOW_EVENT_MONITOR) {
+      ctx.framebuffer_width  = event->width;
+      ctx.framebuffer_height = event->height;
+      ctx.size_dirty         = true;
+    }
+
+    if (event->type == SGG_WINDOW_EVENT_CONTENT_SCALE || event->type == SGG_WINDOW_EVENT_MONITOR) {
+      ctx.content_scale_x = event->x_scale;
+      ctx.content_scale_y = event->y_scale;
+      ctx.size_dirty      = true;
+    }
+
+    if (event->type == SGG_WINDOW_EVENT_MONITOR_SIZE) {
+      ctx.monitor_size = (sgg_size){event->width, event->height};
+      ctx.size_dirty   = true;
+    }
+
+    if (event->type != SGG_WINDOW_EVENT_FRAME) {
+      continue;
+    }
+
+    sgg_size window = {ctx.framebuffer_width, ctx.framebuffer_height};
+    sgg_size new_size;
+    if (sgg__next_backbuffer_size(&ctx, window, window, event->time_ms / 1000.0, &new_size)) {
+      sgg__set_backbuffer_size(&ctx, new_size);
+      result.reallocations++;
+      if (ctx.backbuffer_bytes > result.peak_backbuffer_bytes) {
+        result.peak_backbuffer_bytes = ctx.backbuffer_bytes;
+      }
+    }
+
+    uint64_t backbuffer_pixels = (uint64_t)ctx.backbuffer_size.width * (uint64_t)ctx.backbuffer_size.height;
+    uint64_t window_pixels     = (uint64_t)window.width * (uint64_t)window.height;
+
+    result.frames++;
+    result.backbuffer_pixels += backbuffer_pixels;
+    result.wasted_pixels += backbuffer_pixels - window_pixels;
   }
 
-  g_sgg_state.desc.vsync_disabled = !g_sgg_state.desc.vsync_disabled;
+  return result;
 }
 
 void sgg_max_monitor_size(int* width, int* height) {